@@ -0,0 +1,425 @@
+// Golden-image regression and render cost for every state of the face.
+//
+// The face is rendered through the mock for twelve hours of minutes under
+// each combination of low battery mode, minute_hands, inverted_colors and
+// the battery hand (off, or any of its 21 lengths).  The sweep passes through every hand
+// angle, so both battery hand shapes are covered.  Each combination's frames
+// are hashed and compared to GOLDEN_DIR/states.txt, and a few sample states
+// are compared pixel for pixel against the PBM images next to it.  Alongside,
+// it reports what each frame cost to render.
+//
+//   ./golden [--update] GOLDEN_DIR [OUT_DIR]
+//
+// --update rewrites the golden files from the current rendering.  The
+// rendered image of a mismatching sample is written to OUT_DIR (default .).
+#define _DEFAULT_SOURCE
+
+#include "mock.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SECOND_MS (1000ULL)
+#define MINUTE_MS (60 * SECOND_MS)
+
+// Friday 2014-03-07 00:00:00 UTC.
+static const uint64_t SWEEP_EPOCH_MS = 1394150400ULL * SECOND_MS;
+
+#define SWEEP_FRAMES  (12 * 60)
+#define BATTERY_OFF   (-1)
+#define BATTERY_INCS  20
+#define STATE_COUNT   (2 * 2 * 2 * (BATTERY_INCS + 2))
+#define PBM_STRIDE    (MOCK_SCREEN_WIDTH / 8)
+
+// The phone's packed config message (format 1): one bit per option, keyed
+// like the legacy per-option appKeys.
+#define CONFIG_KEY             0x6
+#define CONFIG_VERSION         (1u << 24)
+#define CONFIG_BLUETOOTH_VIBE  (1u << 0x0)
+#define CONFIG_BATTERY_HAND    (1u << 0x2)
+#define CONFIG_CHARGE_BLINK    (1u << 0x3)
+#define CONFIG_INVERTED_COLORS (1u << 0x4)
+#define CONFIG_MINUTE_HANDS    (1u << 0x5)
+
+// Low battery mode, for the states that have it, turns on below a full
+// battery: it is on for every battery hand length but the longest.
+#define CONFIG_POWER_SAVE_FULL (100u << 8)
+
+typedef struct State {
+    int minute_hands;
+    int inverted_colors;
+    int battery;          // Battery hand increments, or BATTERY_OFF.
+    int power_save;
+} State;
+
+// Sample states whose whole image is checked in.
+typedef struct Sample {
+    const char *name;
+    State      state;
+    int        minute;    // Of the sweep, from 00:00.
+} Sample;
+
+static const Sample SAMPLES[] = {
+    { "10-08_battery80",                      { 0, 0, 16, 0 },          10 * 60 + 8 },
+    { "10-08_battery80_inverted",             { 0, 1, 16, 0 },          10 * 60 + 8 },
+    { "10-08_battery80_minute_hands",         { 1, 0, 16, 0 },          10 * 60 + 8 },
+    { "10-08_battery80_minute_hands_inverted", { 1, 1, 16, 0 },         10 * 60 + 8 },
+    { "10-08_no_battery_hand",                { 0, 0, BATTERY_OFF, 0 }, 10 * 60 + 8 },
+    { "06-15_battery100",                     { 0, 0, 20, 0 },          6 * 60 + 15 },
+    { "11-55_battery0",                       { 0, 0, 0, 0 },           11 * 60 + 55 },
+    { "03-40_battery5",                       { 0, 0, 1, 0 },           3 * 60 + 40 },
+    { "10-08_battery80_low_battery",          { 0, 0, 16, 1 },          10 * 60 + 8 },
+    { "10-08_battery80_minute_hands_low_battery", { 1, 0, 16, 1 },      10 * 60 + 8 },
+};
+
+// What one state's sweep produced.  Filled in by the sweep's process.
+typedef struct Result {
+    bool     done;
+    uint32_t hash;
+    uint64_t pixels;
+    uint32_t pixels_max;
+    uint32_t paths;
+    uint32_t rects;
+    uint64_t render_ns;
+    uint64_t render_ns_max;
+    int      samples_checked;
+    int      samples_failed;
+} Result;
+
+static Result     *results; // Shared with the sweep processes.
+static const char *golden_dir;
+static const char *out_dir = ".";
+static bool       update;
+
+static State state_at(int index) {
+    State state;
+
+    state.power_save      = index / (2 * 2 * (BATTERY_INCS + 2));
+    state.minute_hands    = index / (2 * (BATTERY_INCS + 2)) % 2;
+    state.inverted_colors = index / (BATTERY_INCS + 2) % 2;
+    state.battery         = index % (BATTERY_INCS + 2) - 1;
+    return state;
+}
+
+static bool same_state(State a, State b) {
+    return a.minute_hands == b.minute_hands && a.inverted_colors == b.inverted_colors && a.battery == b.battery &&
+           a.power_save == b.power_save;
+}
+
+static bool pixel_is_black(const uint8_t *frame, int x, int y) {
+    return ((frame[y * MOCK_FRAME_STRIDE + x / 8] >> (x % 8)) & 1) == 0;
+}
+
+static bool write_pbm(const char *path, const uint8_t *frame) {
+    FILE *file = fopen(path, "wb");
+    int  x, y;
+
+    if(file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    fprintf(file, "P4\n%d %d\n", MOCK_SCREEN_WIDTH, MOCK_SCREEN_HEIGHT);
+    for(y = 0; y < MOCK_SCREEN_HEIGHT; y++) {
+        uint8_t row[PBM_STRIDE] = { 0 };
+
+        for(x = 0; x < MOCK_SCREEN_WIDTH; x++) {
+            if(pixel_is_black(frame, x, y)) {
+                row[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+    return fclose(file) == 0;
+}
+
+// Reads a P4 image of the screen's size into `pixels`, PBM_STRIDE bytes a row.
+static bool read_pbm(const char *path, uint8_t *pixels) {
+    FILE *file = fopen(path, "rb");
+    int  width, height;
+    bool ok;
+
+    if(file == NULL) {
+        return false;
+    }
+    ok = fscanf(file, "P4 %d %d", &width, &height) == 2 && fgetc(file) != EOF &&
+         width == MOCK_SCREEN_WIDTH && height == MOCK_SCREEN_HEIGHT &&
+         fread(pixels, PBM_STRIDE, MOCK_SCREEN_HEIGHT, file) == MOCK_SCREEN_HEIGHT;
+    fclose(file);
+    return ok;
+}
+
+// Compares the frame against the sample's golden image, or replaces the image.
+static bool check_sample(const Sample *sample, const uint8_t *frame) {
+    static uint8_t golden[MOCK_SCREEN_HEIGHT * PBM_STRIDE];
+    char           path[512];
+    int            x, y, differ = 0;
+    int            min_x = MOCK_SCREEN_WIDTH, min_y = MOCK_SCREEN_HEIGHT, max_x = 0, max_y = 0;
+
+    snprintf(path, sizeof(path), "%s/%s.pbm", golden_dir, sample->name);
+    if(update) {
+        return write_pbm(path, frame);
+    }
+    if(!read_pbm(path, golden)) {
+        printf("  %s: no golden image at %s\n", sample->name, path);
+        return false;
+    }
+    for(y = 0; y < MOCK_SCREEN_HEIGHT; y++) {
+        for(x = 0; x < MOCK_SCREEN_WIDTH; x++) {
+            bool golden_black = (golden[y * PBM_STRIDE + x / 8] >> (7 - x % 8)) & 1;
+
+            if(golden_black == pixel_is_black(frame, x, y)) {
+                continue;
+            }
+            differ++;
+            min_x = x < min_x ? x : min_x;
+            max_x = x > max_x ? x : max_x;
+            min_y = y < min_y ? y : min_y;
+            max_y = y;
+        }
+    }
+    if(differ == 0) {
+        return true;
+    }
+    snprintf(path, sizeof(path), "%s/%s.actual.pbm", out_dir, sample->name);
+    write_pbm(path, frame);
+    printf("  %s: %d pixels differ within (%d, %d)-(%d, %d), rendered image written to %s\n",
+           sample->name, differ, min_x, min_y, max_x, max_y, path);
+    return false;
+}
+
+static int sweep_index;
+
+// The event loop of a sweep: set the options from the phone, then step
+// through the minutes and fold each frame into the state's result.
+static void sweep(void) {
+    State          state  = state_at(sweep_index);
+    Result         *result = &results[sweep_index];
+    const uint32_t keys[]  = { CONFIG_KEY };
+    uint32_t       values[] = { CONFIG_VERSION | CONFIG_BLUETOOTH_VIBE | CONFIG_CHARGE_BLINK };
+    int            minute;
+    size_t         i, j;
+
+    if(state.battery != BATTERY_OFF) {
+        values[0] |= CONFIG_BATTERY_HAND;
+    }
+    if(state.inverted_colors) {
+        values[0] |= CONFIG_INVERTED_COLORS;
+    }
+    if(state.minute_hands) {
+        values[0] |= CONFIG_MINUTE_HANDS;
+    }
+    if(state.power_save) {
+        values[0] |= CONFIG_POWER_SAVE_FULL;
+    }
+    mock_app_message(keys, values, ARRAY_LENGTH(keys));
+
+    result->hash = 2166136261u;
+    for(minute = 0; minute < SWEEP_FRAMES; minute++) {
+        MockCounters   before = mock_counters;
+        const uint8_t  *frame;
+        uint32_t       pixels;
+        uint64_t       render_ns;
+
+        if(minute > 0) {
+            mock_run_until(SWEEP_EPOCH_MS + minute * MINUTE_MS);
+        }
+        frame     = mock_frame_buffer();
+        pixels    = mock_counters.pixels - before.pixels;
+        render_ns = mock_counters.render_ns - before.render_ns;
+        for(i = 0; i < MOCK_SCREEN_HEIGHT * MOCK_FRAME_STRIDE; i++) {
+            result->hash = (result->hash ^ frame[i]) * 16777619u;
+        }
+        result->pixels    += pixels;
+        result->paths     += mock_counters.path_draws - before.path_draws;
+        result->rects     += mock_counters.fill_rects - before.fill_rects;
+        result->render_ns += render_ns;
+        if(pixels > result->pixels_max) {
+            result->pixels_max = pixels;
+        }
+        if(render_ns > result->render_ns_max) {
+            result->render_ns_max = render_ns;
+        }
+        for(j = 0; j < ARRAY_LENGTH(SAMPLES); j++) {
+            if(SAMPLES[j].minute == minute && same_state(SAMPLES[j].state, state)) {
+                result->samples_checked++;
+                result->samples_failed += !check_sample(&SAMPLES[j], frame);
+            }
+        }
+    }
+}
+
+static bool run_sweep(int index) {
+    State state = state_at(index);
+    pid_t pid;
+    int   status;
+
+    fflush(stdout);
+    pid = fork();
+    if(pid != 0) {
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0 && results[index].done;
+    }
+
+    sweep_index = index;
+    mock_persist_clear();
+    mock_set_clock_ms(SWEEP_EPOCH_MS);
+    mock_battery_event(state.battery == BATTERY_OFF ? 80 : state.battery * 100 / BATTERY_INCS, false, false);
+    mock_bluetooth_event(true);
+    mock_reset_counters();
+    mock_set_event_loop(sweep);
+    pbl_app_main();
+    mock_app_exit();
+    results[index].done = true;
+    fflush(stdout);
+    _exit(0);
+}
+
+static void format_battery(char *text, size_t size, int battery) {
+    if(battery == BATTERY_OFF) {
+        snprintf(text, size, "off");
+    } else {
+        snprintf(text, size, "%d", battery);
+    }
+}
+
+// Compares the state hashes against states.txt, or rewrites it.
+static int check_states(void) {
+    char path[512], line[128];
+    FILE *file;
+    int  index, failed = 0;
+
+    snprintf(path, sizeof(path), "%s/states.txt", golden_dir);
+    file = fopen(path, update ? "w" : "r");
+    if(file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return STATE_COUNT;
+    }
+    if(update) {
+        fprintf(file, "# Hash of the %d frames of 00:00-11:59 for each state, written by host/golden --update.\n", SWEEP_FRAMES);
+        fprintf(file, "# power_save minute_hands inverted_colors battery_hand hash\n");
+    }
+    for(index = 0; index < STATE_COUNT; index++) {
+        State    state = state_at(index);
+        char     battery[8];
+        int      power_save = -1, minute_hands = -1, inverted = -1;
+        char     golden_battery[8] = "";
+        uint32_t golden_hash = 0;
+
+        format_battery(battery, sizeof(battery), state.battery);
+        if(update) {
+            fprintf(file, "%d %d %d %s %08x\n", state.power_save, state.minute_hands, state.inverted_colors, battery, results[index].hash);
+            continue;
+        }
+        do {
+            if(fgets(line, sizeof(line), file) == NULL) {
+                line[0] = '\0';
+                break;
+            }
+        } while(line[0] == '#');
+        if(sscanf(line, "%d %d %d %7s %x", &power_save, &minute_hands, &inverted, golden_battery, &golden_hash) != 5 ||
+           power_save != state.power_save || minute_hands != state.minute_hands || inverted != state.inverted_colors ||
+           strcmp(golden_battery, battery) != 0) {
+            printf("  states.txt is out of step at power_save %d minute_hands %d inverted %d battery %s\n",
+                   state.power_save, state.minute_hands, state.inverted_colors, battery);
+            failed++;
+        } else if(golden_hash != results[index].hash) {
+            printf("  power_save %d minute_hands %d inverted %d battery %s: frames differ (%08x, golden %08x)\n",
+                   state.power_save, state.minute_hands, state.inverted_colors, battery, results[index].hash, golden_hash);
+            failed++;
+        }
+    }
+    fclose(file);
+    return failed;
+}
+
+// Render cost per frame, summed over the states of each row.
+static void print_costs(void) {
+    int power_save, minute_hands, inverted, battery_hand, index;
+
+    printf("%-10s %-12s %8s %7s %7s %11s %10s %10s %10s %9s %9s\n", "power_save", "minute_hands", "inverted",
+           "battery", "frames", "pixels/frm", "pixels_max", "paths/frm", "rects/frm", "us/frm", "us_max");
+    for(power_save = 0; power_save < 2; power_save++) {
+        for(minute_hands = 0; minute_hands < 2; minute_hands++) {
+            for(inverted = 0; inverted < 2; inverted++) {
+                for(battery_hand = 0; battery_hand < 2; battery_hand++) {
+                    uint64_t pixels = 0, render_ns = 0, render_ns_max = 0;
+                    uint32_t pixels_max = 0, paths = 0, rects = 0, frames = 0;
+
+                    for(index = 0; index < STATE_COUNT; index++) {
+                        State  state   = state_at(index);
+                        Result *result = &results[index];
+
+                        if(state.power_save != power_save || state.minute_hands != minute_hands ||
+                           state.inverted_colors != inverted || (state.battery != BATTERY_OFF) != battery_hand) {
+                            continue;
+                        }
+                        frames    += SWEEP_FRAMES;
+                        pixels    += result->pixels;
+                        paths     += result->paths;
+                        rects     += result->rects;
+                        render_ns += result->render_ns;
+                        pixels_max    = result->pixels_max > pixels_max ? result->pixels_max : pixels_max;
+                        render_ns_max = result->render_ns_max > render_ns_max ? result->render_ns_max : render_ns_max;
+                    }
+                    printf("%-10d %-12d %8d %7s %7u %11.0f %10u %10.2f %10.2f %9.2f %9.2f\n",
+                           power_save, minute_hands, inverted, battery_hand ? "0-20" : "off", frames, (double)pixels / frames,
+                           pixels_max, (double)paths / frames, (double)rects / frames, render_ns / 1000.0 / frames,
+                           render_ns_max / 1000.0);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int arg, index, crashed = 0, states_failed, samples_checked = 0, samples_failed = 0;
+
+    for(arg = 1; arg < argc && strcmp(argv[arg], "--update") == 0; arg++) {
+        update = true;
+    }
+    if(arg >= argc) {
+        fprintf(stderr, "usage: %s [--update] GOLDEN_DIR [OUT_DIR]\n", argv[0]);
+        return 2;
+    }
+    golden_dir = argv[arg++];
+    if(arg < argc) {
+        out_dir = argv[arg];
+    }
+
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    results = mmap(NULL, STATE_COUNT * sizeof(Result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(results == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    memset(results, 0, STATE_COUNT * sizeof(Result));
+    mock_persist_clear();
+    for(index = 0; index < STATE_COUNT; index++) {
+        if(!run_sweep(index)) {
+            State state = state_at(index);
+            char  battery[8];
+
+            format_battery(battery, sizeof(battery), state.battery);
+            printf("  power_save %d minute_hands %d inverted %d battery %s: crashed\n",
+                   state.power_save, state.minute_hands, state.inverted_colors, battery);
+            crashed++;
+        }
+        samples_checked += results[index].samples_checked;
+        samples_failed  += results[index].samples_failed;
+    }
+    states_failed = crashed > 0 ? 0 : check_states();
+
+    print_costs();
+    if(update) {
+        printf("golden: wrote %d states and %d images to %s\n", STATE_COUNT, samples_checked, golden_dir);
+        return crashed > 0 || samples_failed > 0 ? 1 : 0;
+    }
+    printf("golden: %d/%d states and %d/%d images match\n", STATE_COUNT - states_failed - crashed, STATE_COUNT,
+           samples_checked - samples_failed, (int)ARRAY_LENGTH(SAMPLES));
+    return crashed > 0 || states_failed > 0 || samples_failed > 0 || samples_checked != ARRAY_LENGTH(SAMPLES) ? 1 : 0;
+}
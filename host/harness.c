@@ -0,0 +1,352 @@
+// Headless trace replay for the watchface.
+//
+// Each trace launches the app from a clean install in its own process (so the
+// app's statics start zeroed, as on the watch), feeds it a scripted stream
+// of OS events through the mock and prints what the watch would have had to
+// do: wakeups, redraws, vibes, allocations, flash traffic and a weighted
+// energy proxy.  A trace may launch the app several times in a row; flash
+// is kept between launches and the counters are summed.
+//
+//   ./harness [trace ...]
+#define _DEFAULT_SOURCE
+
+#include "mock.h"
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Relative energy cost of each counted operation.  The motor dominates, a
+// wakeup out of stop mode costs about two render passes and each flushed
+// display row is cheap but there are 168 of them.
+#define COST_WAKEUP     20
+#define COST_FRAME      10
+#define COST_FLUSH_ROW  0.1
+#define COST_TEXT_SET   5
+#define COST_GPATH      1
+#define COST_PATH_DRAW  2
+#define COST_VIBE       400
+
+#define SECOND_MS (1000ULL)
+#define MINUTE_MS (60 * SECOND_MS)
+#define HOUR_MS   (60 * MINUTE_MS)
+
+// Friday 2014-03-07 00:00:00 UTC.
+static const uint64_t TRACE_EPOCH_MS = 1394150400ULL * SECOND_MS;
+
+static uint64_t trace_start_ms;
+static int      trace_launch; // Zero-based launch number within the trace.
+
+static void run_for(uint64_t ms) {
+    mock_run_until(trace_start_ms + ms);
+}
+
+// A full day of minute ticks on the wrist: no charger, phone in range.
+static void trace_day(void) {
+    run_for(24 * HOUR_MS);
+}
+
+// Plug in at 15%, charge to full, stay on the charger for half an hour, unplug.
+// The charger keeps reporting is_charging at 100% until it is unplugged.
+static void trace_charge(void) {
+    uint64_t t       = MINUTE_MS;
+    int      percent = 15;
+
+    run_for(t);
+    mock_battery_event(percent, true, true);
+    while(percent < 100) {
+        t       += 9 * MINUTE_MS;
+        percent += 5;
+        run_for(t);
+        mock_battery_event(percent, true, true);
+    }
+    t += 30 * MINUTE_MS;
+    run_for(t);
+    mock_battery_event(100, false, false);
+    run_for(t + 10 * MINUTE_MS);
+}
+
+// A flaky link: a burst of five drops two seconds apart, then one clean
+// disconnect and reconnect a minute later.
+static void trace_bluetooth(void) {
+    uint64_t t = MINUTE_MS;
+    int      i;
+
+    for(i = 0; i < 5; i++) {
+        run_for(t);
+        mock_bluetooth_event(false);
+        run_for(t + SECOND_MS);
+        mock_bluetooth_event(true);
+        t += 2 * SECOND_MS;
+    }
+    run_for(5 * MINUTE_MS);
+    mock_bluetooth_event(false);
+    run_for(6 * MINUTE_MS);
+    mock_bluetooth_event(true);
+    run_for(10 * MINUTE_MS);
+}
+
+// Flicking between faces: ten short launches.  The phone inverts the colors
+// during the fourth, in the packed format, and a legacy client turns them
+// back during the seventh.
+#define SWITCH_LAUNCHES  10
+#define SWITCH_PERIOD_MS (5 * MINUTE_MS)
+
+static void trace_switch(void) {
+    if(trace_launch == 3) {
+        // Config format 1: bluetooth vibe, battery hand, charge blink and inverted colors on.
+        const uint32_t keys[]   = { 0x6 };
+        const uint32_t values[] = { 1 << 24 | 0x1d };
+
+        run_for(30 * SECOND_MS);
+        mock_app_message(keys, values, ARRAY_LENGTH(keys));
+    } else if(trace_launch == 6) {
+        // Every option as its own int, inverted colors off.
+        const uint32_t keys[]   = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5 };
+        const uint32_t values[] = { 1, 0, 1, 1, 0, 0 };
+
+        run_for(30 * SECOND_MS);
+        mock_app_message(keys, values, ARRAY_LENGTH(keys));
+    }
+    run_for(MINUTE_MS);
+}
+
+// A day that runs the battery down with low battery mode set at 20%: the phone turns it on (and hourly vibes) just
+// after launch, the battery drops 10% every three hours until it is under the threshold, sits there for six hours,
+// then the watch charges back up in ten-minute steps.
+static void trace_low(void) {
+    // Config format 1: bluetooth vibe, hourly vibe, battery hand and charge blink on, low battery mode below 20%.
+    const uint32_t keys[]   = { 0x6 };
+    const uint32_t values[] = { 1 << 24 | 20 << 8 | 0x0f };
+    uint64_t       t        = 30 * SECOND_MS;
+    int            percent  = 60;
+
+    run_for(t);
+    mock_app_message(keys, values, ARRAY_LENGTH(keys));
+    while(percent > 10) {
+        t       += 3 * HOUR_MS;
+        percent -= 10;
+        run_for(t);
+        mock_battery_event(percent, false, false);
+    }
+    t += 6 * HOUR_MS;
+    run_for(t);
+    mock_battery_event(percent, true, true);
+    while(percent < 100) {
+        t       += 10 * MINUTE_MS;
+        percent += 10;
+        run_for(t);
+        mock_battery_event(percent, percent < 100, true);
+    }
+    run_for(24 * HOUR_MS);
+}
+
+// The phone's side of the options handshake.  Its options have the colors inverted.  Once its script is running it
+// asks the watch for its options, and sends its own only if the answer differs.
+#define PHONE_CONFIG (1 << 24 | 0x1d)
+
+static void phone_ready(void) {
+    const uint32_t question[] = { 0x10 };
+    const uint32_t zero[]     = { 0 };
+    const uint32_t keys[]     = { 0x6 };
+    const uint32_t values[]   = { PHONE_CONFIG };
+    uint32_t       sent       = mock_counters.messages_sent;
+    uint32_t       watch_config;
+
+    mock_app_message(question, zero, ARRAY_LENGTH(question));
+    if(mock_counters.messages_sent == sent || !mock_sent_uint32(0x10, &watch_config) || watch_config == PHONE_CONFIG) {
+        return;
+    }
+    mock_app_message(keys, values, ARRAY_LENGTH(keys));
+}
+
+// A phone that keeps dropping the link: its app starts two seconds after the face, then the connection goes for
+// half a minute every ten minutes for an hour, and the phone's app starts again with each reconnect.
+static void trace_reconnect(void) {
+    uint64_t t = 2 * SECOND_MS;
+    int      i;
+
+    run_for(t);
+    phone_ready();
+    for(i = 0; i < 6; i++) {
+        t += 10 * MINUTE_MS;
+        run_for(t);
+        mock_bluetooth_event(false);
+        run_for(t + 30 * SECOND_MS);
+        mock_bluetooth_event(true);
+        run_for(t + 35 * SECOND_MS);
+        phone_ready();
+    }
+    run_for(t + MINUTE_MS);
+}
+
+// Flicking away from the face and straight back: seven launches eight seconds apart, all in the same minute.  The
+// first draws the face from scratch, the others can put up the frame the previous one left.  The last is gone again
+// before the face is built behind its frame.
+#define FLICK_LAUNCHES  7
+#define FLICK_PERIOD_MS (8 * SECOND_MS)
+
+static void trace_flick(void) {
+    if(trace_launch == FLICK_LAUNCHES - 1) {
+        return;
+    }
+    run_for(5 * SECOND_MS);
+}
+
+typedef struct Trace {
+    const char *name;
+    void       (*run)(void);
+    uint64_t   start_offset_ms; // From TRACE_EPOCH_MS.
+    uint8_t    charge_percent;
+    int        launches;        // Each starts launch_period_ms after the previous one.
+    uint64_t   launch_period_ms;
+} Trace;
+
+static const Trace TRACES[] = {
+    { "day",       trace_day,       0,                    80, 1,               0 },
+    { "charge",    trace_charge,    10 * HOUR_MS + 30000, 15, 1,               0 },
+    { "bluetooth", trace_bluetooth, 14 * HOUR_MS + 45000, 60, 1,               0 },
+    { "switch",    trace_switch,    8 * HOUR_MS + 20000,  70, SWITCH_LAUNCHES, SWITCH_PERIOD_MS },
+    { "low",       trace_low,       0,                    60, 1,               0 },
+    { "reconnect", trace_reconnect, 18 * HOUR_MS + 5000,  90, 1,               0 },
+    { "flick",     trace_flick,     16 * HOUR_MS + 2000,  70, FLICK_LAUNCHES,  FLICK_PERIOD_MS },
+};
+
+// Summed over the launches of a trace.  Shared with the launch processes.
+typedef struct TraceTotals {
+    MockCounters counters;
+    uint32_t     leaked;
+    uint64_t     startup_ns; // From each launch to its first frame on screen.  Not deterministic.
+} TraceTotals;
+
+static TraceTotals *totals;
+
+static double energy_proxy(const MockCounters *c) {
+    return c->wakeups * COST_WAKEUP + c->frames * COST_FRAME + c->flush_rows * COST_FLUSH_ROW +
+           c->text_sets * COST_TEXT_SET + c->gpath_allocs * COST_GPATH + c->path_draws * COST_PATH_DRAW + c->vibes * COST_VIBE;
+}
+
+static void print_header(void) {
+    printf("%-10s %8s %6s %7s %7s %8s %6s %6s %7s %6s %4s %5s %6s %6s %5s %5s %5s %5s %8s %9s %6s %8s %9s %10s\n",
+           "trace", "wakeups", "timers", "frames", "procs", "rows", "dirty", "texts", "glyphs", "resubs", "svc", "vibes", "gpaths", "paths",
+           "p_rd", "p_wr", "m_in", "m_out", "stall_ms", "heap_peak", "leaked", "first_us", "proxy", "frame_hash");
+}
+
+static void add_counters(MockCounters *sum, const MockCounters *c) {
+    sum->wakeups         += c->wakeups;
+    sum->frames          += c->frames;
+    sum->update_procs    += c->update_procs;
+    sum->flush_rows      += c->flush_rows;
+    sum->mark_dirty      += c->mark_dirty;
+    sum->text_sets       += c->text_sets;
+    sum->tick_subscribes += c->tick_subscribes;
+    sum->service_subscribes += c->service_subscribes;
+    sum->timers          += c->timers;
+    sum->vibes           += c->vibes;
+    sum->gpath_allocs    += c->gpath_allocs;
+    sum->path_draws      += c->path_draws;
+    sum->fill_rects      += c->fill_rects;
+    sum->glyphs          += c->glyphs;
+    sum->pixels          += c->pixels;
+    sum->gpath_frees     += c->gpath_frees;
+    sum->font_loads      += c->font_loads;
+    sum->font_unloads    += c->font_unloads;
+    sum->persist_reads   += c->persist_reads;
+    sum->persist_writes  += c->persist_writes;
+    sum->messages        += c->messages;
+    sum->messages_dropped += c->messages_dropped;
+    sum->messages_sent   += c->messages_sent;
+    sum->outbox_bytes    += c->outbox_bytes;
+    sum->stall_ms        += c->stall_ms;
+    sum->render_ns       += c->render_ns;
+    if(c->heap_peak > sum->heap_peak) {
+        sum->heap_peak = c->heap_peak;
+    }
+}
+
+// Runs one launch of the app in a child process and adds its counters to the
+// totals.  Returns false if the launch crashed.
+static bool run_launch(const Trace *trace, int launch) {
+    pid_t    pid;
+    int      status;
+    uint64_t launch_ns;
+
+    fflush(stdout);
+    pid = fork();
+    if(pid != 0) {
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    trace_launch   = launch;
+    trace_start_ms = TRACE_EPOCH_MS + trace->start_offset_ms + launch * trace->launch_period_ms;
+    mock_set_clock_ms(trace_start_ms);
+    mock_battery_event(trace->charge_percent, false, false);
+    mock_bluetooth_event(true);
+    mock_reset_counters();
+
+    mock_set_event_loop(trace->run);
+    launch_ns = mock_monotonic_ns();
+    pbl_app_main();
+    totals->startup_ns += mock_first_frame_ns() - launch_ns;
+    totals->leaked += mock_app_exit();
+    add_counters(&totals->counters, &mock_counters);
+    // Chain the frame hashes so the pixels of every launch count.
+    if(launch == 0) {
+        totals->counters.frame_hash = mock_counters.frame_hash;
+    } else {
+        totals->counters.frame_hash = (totals->counters.frame_hash ^ mock_counters.frame_hash) * 16777619u;
+    }
+    _exit(0);
+}
+
+static bool run_trace(const Trace *trace) {
+    const MockCounters *c = &totals->counters;
+    int                launch;
+
+    memset(totals, 0, sizeof(*totals));
+    mock_persist_clear();
+    for(launch = 0; launch < trace->launches; launch++) {
+        if(!run_launch(trace, launch)) {
+            printf("%-10s crashed\n", trace->name);
+            return false;
+        }
+    }
+
+    printf("%-10s %8u %6u %7u %7u %8u %6u %6u %7u %6u %4u %5u %6u %6u %5u %5u %5u %5u %8u %9u %6u %8.0f %9.0f   %08x\n",
+           trace->name, c->wakeups, c->timers, c->frames, c->update_procs, c->flush_rows, c->mark_dirty, c->text_sets,
+           c->glyphs, c->tick_subscribes, c->service_subscribes, c->vibes, c->gpath_allocs, c->path_draws, c->persist_reads, c->persist_writes, c->messages,
+           c->messages_sent, c->stall_ms, c->heap_peak, totals->leaked,
+           totals->startup_ns / 1000.0 / trace->launches, energy_proxy(c), c->frame_hash);
+    fflush(stdout);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    size_t i;
+    int    arg;
+    bool   ok = true;
+
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    totals = mmap(NULL, sizeof(*totals), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(totals == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    print_header();
+    for(i = 0; i < ARRAY_LENGTH(TRACES); i++) {
+        bool selected = argc < 2;
+
+        for(arg = 1; arg < argc; arg++) {
+            selected |= strcmp(argv[arg], TRACES[i].name) == 0;
+        }
+        if(selected) {
+            ok &= run_trace(&TRACES[i]);
+        }
+    }
+    return ok ? 0 : 1;
+}
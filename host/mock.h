@@ -0,0 +1,85 @@
+// Control surface of the mock Pebble OS, used by the trace harness.
+#pragma once
+
+#include "pebble.h"
+
+#undef main
+#undef malloc
+#undef free
+
+// Aplite's display: 1 bit per pixel, LSB first, 1 = white.
+#define MOCK_SCREEN_WIDTH  144
+#define MOCK_SCREEN_HEIGHT 168
+#define MOCK_FRAME_STRIDE  20
+
+// Everything the mock counts while the app runs.  Reset per trace.
+typedef struct MockCounters {
+    uint32_t wakeups;        // Events delivered to the app (ticks, services, messages).
+    uint32_t frames;         // Render passes of the window (at least one layer was dirty).
+    uint32_t update_procs;   // Layer update procs invoked.
+    uint32_t flush_rows;     // Display rows flushed, the whole screen on every frame.
+    uint32_t mark_dirty;     // layer_mark_dirty calls.
+    uint32_t text_sets;      // text_layer_set_text calls.
+    uint32_t tick_subscribes;
+    uint32_t service_subscribes; // Battery and bluetooth service subscribe / unsubscribe calls.
+    uint32_t timers;         // app_timer callbacks fired.
+    uint32_t vibes;
+    uint32_t gpath_allocs;
+    uint32_t path_draws;     // gpath_draw_filled / gpath_draw_outline rasterizations.
+    uint32_t fill_rects;
+    uint32_t glyphs;         // Glyphs rasterized from a font.
+    uint32_t pixels;         // Pixels plotted by drawing calls, clipped or not.
+    uint32_t gpath_frees;
+    uint32_t font_loads;
+    uint32_t font_unloads;
+    uint32_t persist_reads;  // persist_exists / persist_read_* calls.
+    uint32_t persist_writes; // persist_write_* / persist_delete calls.
+    uint32_t messages;       // AppMessages delivered to the inbox handler.
+    uint32_t messages_dropped; // Too large for the inbox the app opened.
+    uint32_t messages_sent;  // AppMessages the app sent to the phone.
+    uint32_t outbox_bytes;
+    uint32_t frame_hash;     // FNV-1a over each distinct flushed frame, to spot pixel changes.
+    uint32_t stall_ms;       // Time the event loop was blocked inside the app (psleep).
+    uint32_t heap_bytes;     // Live mock allocations.
+    uint32_t heap_peak;
+    uint64_t render_ns;      // Host time spent rendering frames.  Not deterministic.
+} MockCounters;
+
+extern MockCounters mock_counters;
+
+void mock_reset_counters(void);
+
+// Virtual wall clock, in milliseconds since the epoch (UTC).
+void mock_set_clock_ms(uint64_t ms);
+uint64_t mock_clock_ms(void);
+
+// Advances the clock to `ms`, delivering every tick that falls due on the way.
+void mock_run_until(uint64_t ms);
+
+// Host time (CLOCK_MONOTONIC), and what it read when the app's first frame
+// had been drawn, 0 before.  Not deterministic.
+uint64_t mock_monotonic_ns(void);
+uint64_t mock_first_frame_ns(void);
+
+// The frame buffer as last rendered, MOCK_SCREEN_HEIGHT rows of
+// MOCK_FRAME_STRIDE bytes.
+const uint8_t *mock_frame_buffer(void);
+
+// External events, delivered to the app as the OS would.
+void mock_battery_event(uint8_t charge_percent, bool is_charging, bool is_plugged);
+void mock_bluetooth_event(bool connected);
+void mock_app_message(const uint32_t *keys, const uint32_t *values, int count);
+
+// The integer the app last sent to the phone under key, if its last message had one.
+bool mock_sent_uint32(uint32_t key, uint32_t *value);
+
+// The harness installs the trace that app_event_loop() replays.
+void mock_set_event_loop(void (*loop)(void));
+
+// Tears down what the OS owns once the app has returned from main() and
+// reports how many heap bytes the app leaked.
+uint32_t mock_app_exit(void);
+
+// Wipes the fake flash, as after a fresh install.  The flash is shared with
+// processes forked after the first call.
+void mock_persist_clear(void);
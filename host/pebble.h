@@ -0,0 +1,341 @@
+// Host-side stand-in for the Pebble SDK header.
+//
+// Only the part of the SDK that the watchface actually uses is declared here,
+// with the same names and signatures as the real thing, so src/Minimal.c builds
+// unchanged on Linux.  The implementations live in pebble_mock.c and count
+// everything that costs the watch power (wakeups, redraws, vibes, ...).
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The mock renders like aplite.  The SDK passes these on the compiler command line, one set per platform.  With
+// MOCK_PLATFORM_BASALT or MOCK_PLATFORM_CHALK the face can only be compile-checked for that platform: the mock has
+// no color or round frame buffer to draw into.
+#if defined(MOCK_PLATFORM_CHALK)
+#define PBL_PLATFORM_CHALK
+#define PBL_COLOR
+#define PBL_ROUND
+#elif defined(MOCK_PLATFORM_BASALT)
+#define PBL_PLATFORM_BASALT
+#define PBL_COLOR
+#define PBL_RECT
+#else
+#define PBL_PLATFORM_APLITE
+#define PBL_BW
+#define PBL_RECT
+#endif
+
+// The app's main() is renamed so the harness can launch it once per trace.
+#define main pbl_app_main
+int pbl_app_main(void);
+
+// time() reads the harness' virtual clock.
+time_t pbl_mock_time(time_t *tloc);
+#define time(tloc) pbl_mock_time(tloc)
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+// The app's heap is the mock's, so what the app allocates counts towards heap_bytes.
+void *pbl_mock_malloc(size_t size);
+void pbl_mock_free(void *ptr);
+#define malloc(size) pbl_mock_malloc(size)
+#define free(ptr)    pbl_mock_free(ptr)
+
+#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
+
+#define APP_LOG_LEVEL_ERROR   1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO    100
+#define APP_LOG_LEVEL_DEBUG   200
+#define APP_LOG(level, fmt, ...) app_log((level), __FILE__, __LINE__, (fmt), ## __VA_ARGS__)
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...);
+
+// Graphics types.
+typedef struct GPoint {
+    int16_t x;
+    int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint) { (x), (y) })
+
+typedef struct GSize {
+    int16_t w;
+    int16_t h;
+} GSize;
+#define GSize(w, h) ((GSize) { (w), (h) })
+
+typedef struct GRect {
+    GPoint origin;
+    GSize  size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect) { { (x), (y) }, { (w), (h) } })
+#define GRectZero GRect(0, 0, 0, 0)
+
+GPoint grect_center_point(const GRect *rect);
+
+// SDK 3 colors are 8-bit ARGB on every platform; aplite's frame buffer is
+// 1-bit and is what the mock renders into.
+typedef union GColor8 {
+    uint8_t argb;
+    struct {
+        uint8_t b : 2;
+        uint8_t g : 2;
+        uint8_t r : 2;
+        uint8_t a : 2;
+    };
+} GColor8;
+typedef GColor8 GColor;
+
+#define GColorClearARGB8 0x00
+#define GColorBlackARGB8 0xC0
+#define GColorWhiteARGB8 0xFF
+#define GColorClear ((GColor8) { .argb = GColorClearARGB8 })
+#define GColorBlack ((GColor8) { .argb = GColorBlackARGB8 })
+#define GColorWhite ((GColor8) { .argb = GColorWhiteARGB8 })
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+
+typedef enum GTextAlignment {
+    GTextAlignmentLeft,
+    GTextAlignmentCenter,
+    GTextAlignmentRight
+} GTextAlignment;
+
+typedef struct GContext GContext;
+typedef struct FontInfo *GFont;
+
+typedef enum GTextOverflowMode {
+    GTextOverflowModeWordWrap,
+    GTextOverflowModeTrailingEllipsis,
+    GTextOverflowModeFill
+} GTextOverflowMode;
+typedef struct GTextAttributes GTextAttributes;
+
+void graphics_draw_text(GContext *ctx, const char *text, const GFont font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes *text_attributes);
+GSize graphics_text_layout_get_content_size(const char *text, const GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment);
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+
+typedef enum GCornerMask {
+    GCornerNone = 0
+} GCornerMask;
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+
+typedef enum GBitmapFormat {
+    GBitmapFormat1Bit = 0,
+    GBitmapFormat8Bit
+} GBitmapFormat;
+typedef struct GBitmap GBitmap;
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap);
+
+// Trigonometry.
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+
+// Paths.
+typedef struct GPathInfo {
+    uint32_t num_points;
+    GPoint   *points;
+} GPathInfo;
+
+typedef struct GPath {
+    uint32_t num_points;
+    GPoint   *points;
+    int32_t  rotation;
+    GPoint   offset;
+} GPath;
+
+GPath *gpath_create(const GPathInfo *init);
+void gpath_destroy(GPath *gpath);
+void gpath_move_to(GPath *path, GPoint point);
+void gpath_rotate_to(GPath *path, int32_t angle);
+void gpath_draw_filled(GContext *ctx, GPath *path);
+void gpath_draw_outline(GContext *ctx, GPath *path);
+
+// Layers and windows.
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct Window Window;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+void layer_destroy(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+void layer_remove_child_layers(Layer *parent);
+void layer_mark_dirty(Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_background_color(Window *window, GColor background_color);
+void window_stack_push(Window *window, bool animated);
+Layer *window_get_root_layer(const Window *window);
+
+// Fonts and resources.
+typedef uint32_t ResHandle;
+enum {
+    RESOURCE_ID_FONT_LOWER_15 = 1,
+    RESOURCE_ID_FONT_MAIN_40  = 2
+};
+ResHandle resource_get_handle(uint32_t resource_id);
+GFont fonts_load_custom_font(ResHandle handle);
+void fonts_unload_custom_font(GFont font);
+
+// Event services.
+typedef enum TimeUnits {
+    SECOND_UNIT = 1 << 0,
+    MINUTE_UNIT = 1 << 1,
+    HOUR_UNIT   = 1 << 2,
+    DAY_UNIT    = 1 << 3,
+    MONTH_UNIT  = 1 << 4,
+    YEAR_UNIT   = 1 << 5
+} TimeUnits;
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+typedef struct BatteryChargeState {
+    uint8_t charge_percent;
+    bool    is_charging;
+    bool    is_plugged;
+} BatteryChargeState;
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+BatteryChargeState battery_state_service_peek(void);
+
+typedef void (*BluetoothConnectionHandler)(bool connected);
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler);
+void bluetooth_connection_service_unsubscribe(void);
+bool bluetooth_connection_service_peek(void);
+
+void vibes_short_pulse(void);
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+
+// Timers.
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+// System.
+void psleep(int millis);
+bool clock_is_24h_style(void);
+void app_event_loop(void);
+
+// Persistent storage.
+#define PERSIST_DATA_MAX_LENGTH 256
+
+bool persist_exists(uint32_t key);
+int32_t persist_read_int(uint32_t key);
+int persist_write_int(uint32_t key, int32_t value);
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size);
+int persist_write_data(uint32_t key, const void *data, size_t size);
+int persist_delete(uint32_t key);
+
+// AppMessage.
+typedef enum AppMessageResult {
+    APP_MSG_OK               = 0,
+    APP_MSG_NOT_CONNECTED    = 1 << 3,
+    APP_MSG_BUSY             = 1 << 6,
+    APP_MSG_BUFFER_OVERFLOW  = 1 << 11,
+    APP_MSG_OUT_OF_MEMORY    = 1 << 14
+} AppMessageResult;
+
+typedef enum DictionaryResult {
+    DICT_OK                 = 0,
+    DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+    DICT_INVALID_ARGS       = 1 << 2
+} DictionaryResult;
+
+typedef enum TupleType {
+    TUPLE_BYTE_ARRAY = 0,
+    TUPLE_CSTRING    = 1,
+    TUPLE_UINT       = 2,
+    TUPLE_INT        = 3
+} TupleType;
+
+typedef struct Tuple {
+    uint32_t key;
+    TupleType type : 8;
+    uint16_t length;
+    union {
+        uint8_t  data[0];
+        char     cstring[0];
+        uint8_t  uint8;
+        uint16_t uint16;
+        uint32_t uint32;
+        int8_t   int8;
+        int16_t  int16;
+        int32_t  int32;
+    } value[];
+} Tuple;
+
+typedef struct DictionaryIterator DictionaryIterator;
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...);
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size);
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value);
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+void app_message_deregister_callbacks(void);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+// Background worker, from the app's side.
+typedef enum AppWorkerResult {
+    APP_WORKER_RESULT_SUCCESS             = 0,
+    APP_WORKER_RESULT_NO_WORKER           = 1,
+    APP_WORKER_RESULT_DIFFERENT_APP       = 2,
+    APP_WORKER_RESULT_NOT_RUNNING         = 3,
+    APP_WORKER_RESULT_ALREADY_RUNNING     = 4,
+    APP_WORKER_RESULT_ASKING_CONFIRMATION = 5
+} AppWorkerResult;
+
+typedef struct {
+    uint16_t data0;
+    uint16_t data1;
+    uint16_t data2;
+} AppWorkerMessage;
+
+AppWorkerResult app_worker_launch(void);
+bool app_worker_is_running(void);
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data);
@@ -0,0 +1,1395 @@
+// A tiny, deterministic Pebble OS for the host harness.
+//
+// It keeps just enough state to run the watchface the way the firmware would:
+// a virtual clock that drives the tick service, one window with a layer tree
+// that is re-rendered after every event that dirtied it, the battery and
+// bluetooth services, AppMessage and a small fake flash.  Anything that costs the
+// watch energy is counted in mock_counters.
+#define _DEFAULT_SOURCE
+
+#include "mock.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+#define SCREEN_WIDTH  MOCK_SCREEN_WIDTH
+#define SCREEN_HEIGHT MOCK_SCREEN_HEIGHT
+
+static const double PI = 3.14159265358979323846;
+
+MockCounters mock_counters;
+
+void mock_reset_counters(void) {
+    uint32_t heap_bytes = mock_counters.heap_bytes;
+
+    memset(&mock_counters, 0, sizeof(mock_counters));
+    mock_counters.heap_bytes = heap_bytes;
+    mock_counters.heap_peak  = heap_bytes;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+    va_list args;
+
+    if(getenv("MOCK_VERBOSE") == NULL) {
+        return;
+    }
+    va_start(args, fmt);
+    fprintf(stderr, "[%s:%d] ", src_filename, src_line_number);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// Heap accounting.  Every allocation the app asks the OS for goes through here.
+typedef struct MockBlock {
+    size_t size;
+    double align;
+} MockBlock;
+
+static void *mock_alloc(size_t size) {
+    MockBlock *block = calloc(1, sizeof(MockBlock) + size);
+
+    block->size = size;
+    mock_counters.heap_bytes += size;
+    if(mock_counters.heap_bytes > mock_counters.heap_peak) {
+        mock_counters.heap_peak = mock_counters.heap_bytes;
+    }
+    return block + 1;
+}
+
+static void mock_free(void *ptr) {
+    MockBlock *block;
+
+    if(ptr == NULL) {
+        return;
+    }
+    block = (MockBlock *)ptr - 1;
+    mock_counters.heap_bytes -= block->size;
+    free(block);
+}
+
+void *pbl_mock_malloc(size_t size) {
+    return mock_alloc(size);
+}
+
+void pbl_mock_free(void *ptr) {
+    mock_free(ptr);
+}
+
+// Clock.
+static uint64_t clock_ms;
+
+void mock_set_clock_ms(uint64_t ms) {
+    clock_ms = ms;
+}
+
+uint64_t mock_clock_ms(void) {
+    return clock_ms;
+}
+
+time_t pbl_mock_time(time_t *tloc) {
+    time_t now = (time_t)(clock_ms / 1000);
+
+    if(tloc != NULL) {
+        *tloc = now;
+    }
+    return now;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+    uint16_t ms = (uint16_t)(clock_ms % 1000);
+
+    pbl_mock_time(tloc);
+    if(out_ms != NULL) {
+        *out_ms = ms;
+    }
+    return ms;
+}
+
+bool clock_is_24h_style(void) {
+    return false;
+}
+
+void psleep(int millis) {
+    clock_ms             += millis;
+    mock_counters.stall_ms += millis;
+}
+
+// Geometry and trigonometry.
+GPoint grect_center_point(const GRect *rect) {
+    return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+int32_t sin_lookup(int32_t angle) {
+    return (int32_t)lround(sin(2.0 * PI * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+    return (int32_t)lround(cos(2.0 * PI * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+// Graphics: a 1-bit aplite frame buffer, one bit per pixel, LSB first,
+// 1 = white.  Drawing is relative to the layer being rendered and clipped to
+// it, as in the firmware.
+#define FRAME_BUFFER_STRIDE MOCK_FRAME_STRIDE
+
+static uint8_t frame_buffer[SCREEN_HEIGHT][FRAME_BUFFER_STRIDE];
+
+struct GContext {
+    GColor stroke_color;
+    GColor fill_color;
+    GColor text_color;
+    GPoint origin; // Of the current layer, in screen coordinates.
+    GRect  clip;   // In screen coordinates.
+};
+
+struct GBitmap {
+    uint8_t  *data;
+    uint16_t bytes_per_row;
+    GRect    bounds;
+};
+
+static GContext graphics_context;
+static GBitmap  frame_buffer_bitmap = { &frame_buffer[0][0], FRAME_BUFFER_STRIDE, { { 0, 0 }, { SCREEN_WIDTH, SCREEN_HEIGHT } } };
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+    return x.argb == y.argb;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+    ctx->stroke_color = color;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+    ctx->fill_color = color;
+}
+
+static void frame_buffer_fill(GColor color) {
+    memset(frame_buffer, color.argb == GColorWhiteARGB8 ? 0xff : 0x00, sizeof(frame_buffer));
+}
+
+// Sets the pixel at (x, y) in layer coordinates.
+static void plot(GContext *ctx, int x, int y, GColor color) {
+    x += ctx->origin.x;
+    y += ctx->origin.y;
+    mock_counters.pixels++;
+    if(color.a == 0 || x < ctx->clip.origin.x || y < ctx->clip.origin.y ||
+       x >= ctx->clip.origin.x + ctx->clip.size.w || y >= ctx->clip.origin.y + ctx->clip.size.h) {
+        return;
+    }
+    if(color.argb == GColorWhiteARGB8) {
+        frame_buffer[y][x / 8] |= 1 << (x % 8);
+    } else {
+        frame_buffer[y][x / 8] &= ~(1 << (x % 8));
+    }
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+    int x, y;
+
+    mock_counters.fill_rects++;
+    for(y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+        for(x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+            plot(ctx, x, y, ctx->fill_color);
+        }
+    }
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+    int dx  = abs(p1.x - p0.x), sx = p0.x < p1.x ? 1 : -1;
+    int dy  = -abs(p1.y - p0.y), sy = p0.y < p1.y ? 1 : -1;
+    int err = dx + dy;
+    int x   = p0.x, y = p0.y, e2;
+
+    for(;;) {
+        plot(ctx, x, y, ctx->stroke_color);
+        if(x == p1.x && y == p1.y) {
+            break;
+        }
+        e2 = 2 * err;
+        if(e2 >= dy) {
+            err += dy;
+            x   += sx;
+        }
+        if(e2 <= dx) {
+            err += dx;
+            y   += sy;
+        }
+    }
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+    return &frame_buffer_bitmap;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+    return buffer == &frame_buffer_bitmap;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+    return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+    return bitmap->bytes_per_row;
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+    return bitmap->bounds;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+    return GBitmapFormat1Bit;
+}
+
+// Paths.  Like the firmware, a path references the caller's points.
+GPath *gpath_create(const GPathInfo *init) {
+    GPath *path = mock_alloc(sizeof(GPath));
+
+    path->num_points = init->num_points;
+    path->points     = init->points;
+    mock_counters.gpath_allocs++;
+    return path;
+}
+
+void gpath_destroy(GPath *gpath) {
+    if(gpath != NULL) {
+        mock_counters.gpath_frees++;
+    }
+    mock_free(gpath);
+}
+
+void gpath_move_to(GPath *path, GPoint point) {
+    path->offset = point;
+}
+
+void gpath_rotate_to(GPath *path, int32_t angle) {
+    path->rotation = angle;
+}
+
+#define PATH_POINTS_MAX 16
+
+// Rotates and offsets the path's points with the firmware's fixed-point math.
+static uint32_t transform_path(const GPath *path, GPoint *points) {
+    int32_t  cosine = cos_lookup(path->rotation);
+    int32_t  sine   = sin_lookup(path->rotation);
+    uint32_t i, count = path->num_points < PATH_POINTS_MAX ? path->num_points : PATH_POINTS_MAX;
+
+    for(i = 0; i < count; i++) {
+        points[i].x = (path->points[i].x * cosine - path->points[i].y * sine) / TRIG_MAX_RATIO + path->offset.x;
+        points[i].y = (path->points[i].y * cosine + path->points[i].x * sine) / TRIG_MAX_RATIO + path->offset.y;
+    }
+    return count;
+}
+
+static int compare_int(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+// Even-odd scanline fill: each row is filled between pairs of edge crossings.
+void gpath_draw_filled(GContext *ctx, GPath *path) {
+    GPoint   points[PATH_POINTS_MAX];
+    int      crossings[PATH_POINTS_MAX];
+    uint32_t count = transform_path(path, points), i;
+    int      min_y, max_y, y, x, n, k;
+
+    mock_counters.path_draws++;
+    if(count < 3) {
+        return;
+    }
+    min_y = max_y = points[0].y;
+    for(i = 1; i < count; i++) {
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+    for(y = min_y; y <= max_y; y++) {
+        n = 0;
+        for(i = 0; i < count; i++) {
+            GPoint a = points[i], b = points[(i + 1) % count];
+
+            if(a.y == b.y || y < (a.y < b.y ? a.y : b.y) || y >= (a.y < b.y ? b.y : a.y)) {
+                continue;
+            }
+            crossings[n++] = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+        }
+        qsort(crossings, n, sizeof(int), compare_int);
+        for(k = 0; k + 1 < n; k += 2) {
+            for(x = crossings[k]; x <= crossings[k + 1]; x++) {
+                plot(ctx, x, y, ctx->fill_color);
+            }
+        }
+    }
+}
+
+void gpath_draw_outline(GContext *ctx, GPath *path) {
+    GPoint   points[PATH_POINTS_MAX];
+    uint32_t count = transform_path(path, points), i;
+
+    mock_counters.path_draws++;
+    for(i = 0; i < count; i++) {
+        graphics_draw_line(ctx, points[i], points[(i + 1) % count]);
+    }
+}
+
+// Layers.
+struct Layer {
+    GRect           frame;
+    GRect           bounds;
+    LayerUpdateProc update_proc;
+    Layer           *parent;
+    Layer           *first_child;
+    Layer           *next_sibling;
+    bool            is_text;
+};
+
+struct TextLayer {
+    Layer          layer;
+    const char     *text;
+    GFont          font;
+    GColor         text_color;
+    GColor         background_color;
+    GTextAlignment alignment;
+};
+
+struct Window {
+    Layer  root_layer;
+    GColor background_color;
+};
+
+static Window *top_window;
+static bool   window_dirty;
+static bool   rendering;
+
+static GRect layer_frame_in_window(const Layer *layer) {
+    GRect frame = layer->frame;
+
+    for(layer = layer->parent; layer != NULL; layer = layer->parent) {
+        frame.origin.x += layer->frame.origin.x;
+        frame.origin.y += layer->frame.origin.y;
+    }
+    return frame;
+}
+
+static void mark_window_dirty(void) {
+    // Layers changed while the window is being drawn are picked up by the
+    // pass in progress rather than scheduling another one.
+    if(!rendering) {
+        window_dirty = true;
+    }
+}
+
+static void layer_init(Layer *layer, GRect frame) {
+    memset(layer, 0, sizeof(*layer));
+    layer->frame  = frame;
+    layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+}
+
+Layer *layer_create(GRect frame) {
+    Layer *layer = mock_alloc(sizeof(Layer));
+
+    layer_init(layer, frame);
+    return layer;
+}
+
+void layer_remove_from_parent(Layer *child) {
+    Layer **link;
+
+    if(child->parent == NULL) {
+        return;
+    }
+    for(link = &child->parent->first_child; *link != NULL; link = &(*link)->next_sibling) {
+        if(*link == child) {
+            *link = child->next_sibling;
+            break;
+        }
+    }
+    child->parent       = NULL;
+    child->next_sibling = NULL;
+}
+
+void layer_destroy(Layer *layer) {
+    if(layer == NULL) {
+        return;
+    }
+    layer_remove_from_parent(layer);
+    mock_free(layer);
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+    layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+    Layer **link;
+
+    layer_remove_from_parent(child);
+    for(link = &parent->first_child; *link != NULL; link = &(*link)->next_sibling) {
+    }
+    *link         = child;
+    child->parent = parent;
+    layer_mark_dirty(child);
+}
+
+void layer_remove_child_layers(Layer *parent) {
+    while(parent->first_child != NULL) {
+        layer_remove_from_parent(parent->first_child);
+    }
+}
+
+void layer_mark_dirty(Layer *layer) {
+    mock_counters.mark_dirty++;
+    // The firmware shrugs off a NULL layer, so the mock does too.
+    if(layer == NULL) {
+        return;
+    }
+    mark_window_dirty();
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+    return layer->bounds;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+    return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+    layer->frame  = frame;
+    layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+    mark_window_dirty();
+}
+
+TextLayer *text_layer_create(GRect frame) {
+    TextLayer *text_layer = mock_alloc(sizeof(TextLayer));
+
+    layer_init(&text_layer->layer, frame);
+    text_layer->layer.is_text = true;
+    text_layer->text_color    = GColorBlack;
+    text_layer->background_color = GColorWhite;
+    return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+    if(text_layer == NULL) {
+        return;
+    }
+    layer_remove_from_parent(&text_layer->layer);
+    mock_free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+    return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+    mock_counters.text_sets++;
+    if(text_layer == NULL) {
+        return;
+    }
+    text_layer->text = text;
+    layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+    if(text_layer == NULL) {
+        return;
+    }
+    text_layer->text_color = color;
+    layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+    text_layer->background_color = color;
+    layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+    text_layer->alignment = text_alignment;
+    layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+    text_layer->font = font;
+    layer_mark_dirty(&text_layer->layer);
+}
+
+Window *window_create(void) {
+    Window *window = mock_alloc(sizeof(Window));
+
+    layer_init(&window->root_layer, GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+    window->background_color = GColorWhite;
+    return window;
+}
+
+void window_destroy(Window *window) {
+    if(window == top_window) {
+        top_window = NULL;
+    }
+    mock_free(window);
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+    window->background_color = background_color;
+    layer_mark_dirty(&window->root_layer);
+}
+
+void window_stack_push(Window *window, bool animated) {
+    top_window = window;
+    layer_mark_dirty(&window->root_layer);
+}
+
+Layer *window_get_root_layer(const Window *window) {
+    return (Layer *)&window->root_layer;
+}
+
+// Renders the layer tree the way the firmware does: the window background is
+// filled and every layer redrawn, so the whole screen is flushed each pass.
+static GRect intersect_rect(GRect a, GRect b) {
+    int16_t x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+    int16_t y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+    int16_t x1 = a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+    int16_t y1 = a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+
+    return GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+// Text is set in a built-in 5x7 bitmap font, scaled per font resource, rather
+// than the real TTF: the point is to see which glyphs are drawn where, not
+// what they look like on the watch.  Characters it lacks draw as a box, as
+// the firmware does for glyphs missing from a font.
+#define GLYPH_WIDTH  5
+#define GLYPH_HEIGHT 7
+
+// Each font draws the built-in glyphs at its own scale.
+struct FontInfo {
+    ResHandle handle;
+    uint8_t   scale_x;
+    uint8_t   scale_y;
+};
+
+typedef struct Glyph {
+    char    c;
+    uint8_t rows[GLYPH_HEIGHT]; // Bit 4 is the leftmost column.
+} Glyph;
+
+static const Glyph GLYPHS[] = {
+    { ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    { '0', { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e } },
+    { '1', { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e } },
+    { '2', { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f } },
+    { '3', { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e } },
+    { '4', { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 } },
+    { '5', { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e } },
+    { '6', { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e } },
+    { '7', { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+    { '8', { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e } },
+    { '9', { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c } },
+    { 'A', { 0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11 } },
+    { 'D', { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c } },
+    { 'F', { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 } },
+    { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c } },
+    { 'M', { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+    { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+    { 'O', { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e } },
+    { 'S', { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e } },
+    { 'T', { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+    { 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a } },
+    { 'a', { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f } },
+    { 'b', { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e } },
+    { 'c', { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e } },
+    { 'd', { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f } },
+    { 'e', { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e } },
+    { 'g', { 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e } },
+    { 'h', { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 } },
+    { 'i', { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e } },
+    { 'l', { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e } },
+    { 'n', { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 } },
+    { 'o', { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e } },
+    { 'p', { 0x00, 0x00, 0x1e, 0x11, 0x1e, 0x10, 0x10 } },
+    { 'r', { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 } },
+    { 't', { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06 } },
+    { 'u', { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d } },
+    { 'v', { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04 } },
+    { 'y', { 0x00, 0x00, 0x11, 0x11, 0x0f, 0x01, 0x0e } },
+};
+
+static const Glyph MISSING_GLYPH = { '?', { 0x1f, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1f } };
+
+static const Glyph *find_glyph(char c) {
+    size_t i;
+
+    for(i = 0; i < ARRAY_LENGTH(GLYPHS); i++) {
+        if(GLYPHS[i].c == c) {
+            return &GLYPHS[i];
+        }
+    }
+    return &MISSING_GLYPH;
+}
+
+// Glyphs are set one scaled glyph plus a scaled column apart, on one line.
+static GSize text_size(const char *text, GFont font) {
+    int length = (int)strlen(text);
+
+    if(length == 0) {
+        return GSize(0, 0);
+    }
+    return GSize(length * (GLYPH_WIDTH + 1) * font->scale_x - font->scale_x, GLYPH_HEIGHT * font->scale_y);
+}
+
+static void draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextAlignment alignment, GColor color) {
+    int        scale_x = font->scale_x;
+    int        scale_y = font->scale_y;
+    int        advance = (GLYPH_WIDTH + 1) * scale_x;
+    int        width   = text_size(text, font).w;
+    int        left, gx, gy, i;
+    const char *c;
+
+    left = alignment == GTextAlignmentLeft ? 0 : alignment == GTextAlignmentRight ? box.size.w - width : (box.size.w - width) / 2;
+    for(c = text, i = 0; *c != '\0'; c++, i++) {
+        const Glyph *glyph = find_glyph(*c);
+
+        mock_counters.glyphs++;
+        for(gy = 0; gy < GLYPH_HEIGHT * scale_y; gy++) {
+            for(gx = 0; gx < GLYPH_WIDTH * scale_x; gx++) {
+                if((glyph->rows[gy / scale_y] >> (GLYPH_WIDTH - 1 - gx / scale_x)) & 1) {
+                    plot(ctx, box.origin.x + left + i * advance + gx, box.origin.y + gy, color);
+                }
+            }
+        }
+    }
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+    ctx->text_color = color;
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, const GFont font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+                        GTextAttributes *text_attributes) {
+    if(text != NULL && font != NULL) {
+        draw_text(ctx, text, font, box, alignment, ctx->text_color);
+    }
+}
+
+GSize graphics_text_layout_get_content_size(const char *text, const GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode, const GTextAlignment alignment) {
+    return text != NULL && font != NULL ? text_size(text, font) : GSize(0, 0);
+}
+
+static void draw_text_layer(TextLayer *text_layer, GContext *ctx) {
+    GSize size = text_layer->layer.frame.size;
+
+    if(text_layer->background_color.a != 0) {
+        ctx->fill_color = text_layer->background_color;
+        graphics_fill_rect(ctx, GRect(0, 0, size.w, size.h), 0, GCornerNone);
+    }
+    if(text_layer->text == NULL || text_layer->font == NULL) {
+        return;
+    }
+    draw_text(ctx, text_layer->text, text_layer->font, GRect(0, 0, size.w, size.h), text_layer->alignment, text_layer->text_color);
+}
+
+static void render_layer(Layer *layer, GRect parent_clip) {
+    GRect frame = layer_frame_in_window(layer);
+    GRect clip  = intersect_rect(parent_clip, frame);
+    Layer *child;
+
+    if(layer->update_proc != NULL || layer->is_text) {
+        mock_counters.update_procs++;
+    }
+    // Each layer starts from the default drawing state.
+    graphics_context.stroke_color = GColorBlack;
+    graphics_context.fill_color   = GColorBlack;
+    graphics_context.text_color   = GColorBlack;
+    graphics_context.origin       = frame.origin;
+    graphics_context.clip         = clip;
+    if(layer->update_proc != NULL) {
+        layer->update_proc(layer, &graphics_context);
+    } else if(layer->is_text) {
+        draw_text_layer((TextLayer *)layer, &graphics_context);
+    }
+    for(child = layer->first_child; child != NULL; child = child->next_sibling) {
+        render_layer(child, clip);
+    }
+}
+
+// Folds the frame into frame_hash if it differs from the last one flushed, so
+// redundant redraws don't change the hash but any visible difference does.
+static void hash_frame_buffer(void) {
+    static uint8_t last_frame[SCREEN_HEIGHT][FRAME_BUFFER_STRIDE];
+    const uint8_t  *byte = &frame_buffer[0][0];
+    size_t         i;
+
+    if(mock_counters.frame_hash != 0 && memcmp(last_frame, frame_buffer, sizeof(frame_buffer)) == 0) {
+        return;
+    }
+    memcpy(last_frame, frame_buffer, sizeof(frame_buffer));
+    if(mock_counters.frame_hash == 0) {
+        mock_counters.frame_hash = 2166136261u;
+    }
+    for(i = 0; i < sizeof(frame_buffer); i++) {
+        mock_counters.frame_hash = (mock_counters.frame_hash ^ byte[i]) * 16777619u;
+    }
+}
+
+const uint8_t *mock_frame_buffer(void) {
+    return &frame_buffer[0][0];
+}
+
+uint64_t mock_monotonic_ns(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint64_t first_frame_ns;
+
+uint64_t mock_first_frame_ns(void) {
+    return first_frame_ns;
+}
+
+static void render_if_dirty(void) {
+    uint64_t start_ns;
+
+    if(!window_dirty || top_window == NULL) {
+        window_dirty = false;
+        return;
+    }
+    window_dirty = false;
+    mock_counters.frames++;
+    mock_counters.update_procs++; // The window's own background fill.
+    start_ns = mock_monotonic_ns();
+    frame_buffer_fill(top_window->background_color);
+    rendering = true;
+    render_layer(&top_window->root_layer, top_window->root_layer.frame);
+    rendering = false;
+    mock_counters.render_ns += mock_monotonic_ns() - start_ns;
+    if(first_frame_ns == 0) {
+        first_frame_ns = mock_monotonic_ns();
+    }
+
+    hash_frame_buffer();
+    mock_counters.flush_rows += SCREEN_HEIGHT;
+}
+
+// Fonts and resources.
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+    return resource_id;
+}
+
+GFont fonts_load_custom_font(ResHandle handle) {
+    // Sized to fit the layers the face sets them in: two digits across the
+    // 50 pixel number, "Sep 30" across the 60 pixel date.
+    int   scale_x = handle == RESOURCE_ID_FONT_MAIN_40 ? 4 : 1;
+    int   scale_y = handle == RESOURCE_ID_FONT_MAIN_40 ? 4 : 2;
+    // The allocation stands in for the glyph bitmaps the firmware keeps for
+    // a loaded font: the digits of the number font, every glyph of the other.
+    int   glyphs  = handle == RESOURCE_ID_FONT_MAIN_40 ? 10 : (int)ARRAY_LENGTH(GLYPHS);
+    GFont font    = mock_alloc(sizeof(struct FontInfo) + glyphs * ((GLYPH_WIDTH * scale_x + 7) / 8) * GLYPH_HEIGHT * scale_y);
+
+    font->handle  = handle;
+    font->scale_x = scale_x;
+    font->scale_y = scale_y;
+    mock_counters.font_loads++;
+    return font;
+}
+
+void fonts_unload_custom_font(GFont font) {
+    mock_counters.font_unloads++;
+    mock_free(font);
+}
+
+// Vibes.
+void vibes_short_pulse(void) {
+    mock_counters.vibes++;
+}
+
+void vibes_long_pulse(void) {
+    mock_counters.vibes++;
+}
+
+void vibes_double_pulse(void) {
+    mock_counters.vibes++;
+}
+
+// Tick timer service.
+static TimeUnits   tick_units;
+static TickHandler tick_handler;
+static uint64_t    next_tick_ms;
+static struct tm   last_tick_time;
+
+static uint64_t tick_period_ms(TimeUnits units) {
+    if(units & SECOND_UNIT) {
+        return 1000;
+    }
+    if(units & MINUTE_UNIT) {
+        return 60 * 1000;
+    }
+    if(units & HOUR_UNIT) {
+        return 60 * 60 * 1000;
+    }
+    return 24 * 60 * 60 * 1000;
+}
+
+static void current_tm(struct tm *result) {
+    time_t now = (time_t)(clock_ms / 1000);
+
+    localtime_r(&now, result);
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units_, TickHandler handler) {
+    uint64_t period = tick_period_ms(tick_units_);
+
+    mock_counters.tick_subscribes++;
+    tick_units   = tick_units_;
+    tick_handler = handler;
+    next_tick_ms = (clock_ms / period + 1) * period;
+    current_tm(&last_tick_time);
+}
+
+void tick_timer_service_unsubscribe(void) {
+    tick_handler = NULL;
+}
+
+static void deliver_tick(void) {
+    struct tm now;
+    TimeUnits changed = 0;
+    uint64_t  period  = tick_period_ms(tick_units);
+
+    current_tm(&now);
+    if(now.tm_sec != last_tick_time.tm_sec) {
+        changed |= SECOND_UNIT;
+    }
+    if(now.tm_min != last_tick_time.tm_min) {
+        changed |= MINUTE_UNIT;
+    }
+    if(now.tm_hour != last_tick_time.tm_hour) {
+        changed |= HOUR_UNIT;
+    }
+    if(now.tm_mday != last_tick_time.tm_mday) {
+        changed |= DAY_UNIT;
+    }
+    if(now.tm_mon != last_tick_time.tm_mon) {
+        changed |= MONTH_UNIT;
+    }
+    if(now.tm_year != last_tick_time.tm_year) {
+        changed |= YEAR_UNIT;
+    }
+    last_tick_time = now;
+    next_tick_ms   = (clock_ms / period + 1) * period;
+
+    mock_counters.wakeups++;
+    tick_handler(&now, changed);
+    render_if_dirty();
+}
+
+// App timers.
+#define APP_TIMERS_MAX 8
+
+struct AppTimer {
+    bool             armed;
+    uint64_t         due_ms;
+    AppTimerCallback callback;
+    void             *data;
+};
+
+static AppTimer app_timers[APP_TIMERS_MAX];
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+    int i;
+
+    for(i = 0; i < APP_TIMERS_MAX; i++) {
+        if(!app_timers[i].armed) {
+            app_timers[i].armed    = true;
+            app_timers[i].due_ms   = clock_ms + timeout_ms;
+            app_timers[i].callback = callback;
+            app_timers[i].data     = callback_data;
+            return &app_timers[i];
+        }
+    }
+    return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+    if(timer_handle == NULL || !timer_handle->armed) {
+        return false;
+    }
+    timer_handle->due_ms = clock_ms + new_timeout_ms;
+    return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+    if(timer_handle != NULL) {
+        timer_handle->armed = false;
+    }
+}
+
+static AppTimer *next_app_timer(void) {
+    AppTimer *next = NULL;
+    int      i;
+
+    for(i = 0; i < APP_TIMERS_MAX; i++) {
+        if(app_timers[i].armed && (next == NULL || app_timers[i].due_ms < next->due_ms)) {
+            next = &app_timers[i];
+        }
+    }
+    return next;
+}
+
+static void fire_app_timer(AppTimer *timer) {
+    // A timer is spent once it fires; the callback may register a new one.
+    timer->armed = false;
+    mock_counters.wakeups++;
+    mock_counters.timers++;
+    timer->callback(timer->data);
+    render_if_dirty();
+}
+
+static uint64_t outbox_ack_due(void);
+static void deliver_outbox_ack(void);
+
+void mock_run_until(uint64_t ms) {
+    for(;;) {
+        AppTimer *timer   = next_app_timer();
+        uint64_t tick_due = tick_handler != NULL ? next_tick_ms : UINT64_MAX;
+        uint64_t ack_due  = outbox_ack_due();
+        uint64_t due      = timer != NULL && timer->due_ms < tick_due ? timer->due_ms : tick_due;
+
+        due = ack_due < due ? ack_due : due;
+
+        if(due > ms) {
+            break;
+        }
+        // Anything that came due while the app was blocked is delivered late.
+        if(due > clock_ms) {
+            clock_ms = due;
+        }
+        if(ack_due == due) {
+            deliver_outbox_ack();
+        } else if(timer != NULL && timer->due_ms == due) {
+            fire_app_timer(timer);
+        } else {
+            deliver_tick();
+        }
+    }
+    if(ms > clock_ms) {
+        clock_ms = ms;
+    }
+}
+
+// Battery state service.
+static BatteryStateHandler battery_handler;
+static BatteryChargeState  battery_state = { 80, false, false };
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+    mock_counters.service_subscribes++;
+    battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+    mock_counters.service_subscribes++;
+    battery_handler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+    return battery_state;
+}
+
+void mock_battery_event(uint8_t charge_percent, bool is_charging, bool is_plugged) {
+    battery_state.charge_percent = charge_percent;
+    battery_state.is_charging    = is_charging;
+    battery_state.is_plugged     = is_plugged;
+    if(battery_handler != NULL) {
+        mock_counters.wakeups++;
+        battery_handler(battery_state);
+        render_if_dirty();
+    }
+}
+
+// Bluetooth connection service.
+static BluetoothConnectionHandler bluetooth_handler;
+static bool                       bluetooth_connected = true;
+
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler) {
+    mock_counters.service_subscribes++;
+    bluetooth_handler = handler;
+}
+
+void bluetooth_connection_service_unsubscribe(void) {
+    mock_counters.service_subscribes++;
+    bluetooth_handler = NULL;
+}
+
+bool bluetooth_connection_service_peek(void) {
+    return bluetooth_connected;
+}
+
+void mock_bluetooth_event(bool connected) {
+    bluetooth_connected = connected;
+    if(bluetooth_handler != NULL) {
+        mock_counters.wakeups++;
+        bluetooth_handler(connected);
+        render_if_dirty();
+    }
+}
+
+// AppMessage.  Incoming dictionaries are built as a flat array of integer
+// tuples, which is all the phone sends.  Outgoing ones are sized as the SDK
+// lays them out and counted; only their integers are kept, for the harness to
+// play the phone's side.  The phone acknowledges a message OUTBOX_ACK_MS
+// after it was sent; until then the outbox is busy.
+#define DICT_TUPLES_MAX 16
+#define OUTBOX_ACK_MS   100
+
+struct DictionaryIterator {
+    uint8_t  count;
+    uint32_t storage[DICT_TUPLES_MAX][(sizeof(Tuple) + sizeof(uint32_t)) / sizeof(uint32_t)];
+    uint32_t size;     // Bytes written, outgoing only.
+    uint32_t capacity;
+};
+
+static uint32_t                inbox_size;
+static uint32_t                outbox_size;
+static DictionaryIterator      outbox;
+static DictionaryIterator      last_sent;
+static bool                    outbox_open;
+static bool                    outbox_in_flight;
+static uint64_t                outbox_ack_ms;
+static void                    *message_buffers;
+static AppMessageInboxReceived inbox_received_handler;
+static AppMessageOutboxSent    outbox_sent_handler;
+static AppMessageOutboxFailed  outbox_failed_handler;
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+    uint32_t size = 1;
+    va_list  args;
+    int      i;
+
+    va_start(args, tuple_count);
+    for(i = 0; i < tuple_count; i++) {
+        size += 7 + va_arg(args, uint32_t);
+    }
+    va_end(args);
+    return size;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+    int i;
+
+    for(i = 0; i < iter->count; i++) {
+        Tuple *tuple = (Tuple *)iter->storage[i];
+
+        if(tuple->key == key) {
+            return tuple;
+        }
+    }
+    return NULL;
+}
+
+// Adds a tuple header to an outgoing dictionary.  Returns NULL if it is full.
+static Tuple *dict_add_tuple(DictionaryIterator *iter, const uint32_t key, TupleType type, uint16_t size) {
+    Tuple *tuple;
+
+    if(iter->size + 7 + size > iter->capacity || iter->count == DICT_TUPLES_MAX) {
+        return NULL;
+    }
+    tuple         = (Tuple *)iter->storage[iter->count++];
+    tuple->key    = key;
+    tuple->type   = type;
+    tuple->length = size;
+    iter->size   += 7 + size;
+    return tuple;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size) {
+    if(iter == NULL || data == NULL) {
+        return DICT_INVALID_ARGS;
+    }
+    return dict_add_tuple(iter, key, TUPLE_BYTE_ARRAY, size) != NULL ? DICT_OK : DICT_NOT_ENOUGH_STORAGE;
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value) {
+    Tuple *tuple;
+
+    if(iter == NULL) {
+        return DICT_INVALID_ARGS;
+    }
+    tuple = dict_add_tuple(iter, key, TUPLE_UINT, sizeof(value));
+    if(tuple == NULL) {
+        return DICT_NOT_ENOUGH_STORAGE;
+    }
+    tuple->value->uint32 = value;
+    return DICT_OK;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+    if(outbox_open || outbox_in_flight) {
+        return APP_MSG_BUSY;
+    }
+    memset(&outbox, 0, sizeof(outbox));
+    outbox.size     = dict_calc_buffer_size(0);
+    outbox.capacity = outbox_size;
+    outbox_open     = true;
+    *iterator       = &outbox;
+    return APP_MSG_OK;
+}
+
+// The message is handed over at once and acknowledged later, as an event.
+AppMessageResult app_message_outbox_send(void) {
+    if(!outbox_open) {
+        return APP_MSG_BUSY;
+    }
+    outbox_open = false;
+    if(!bluetooth_connected) {
+        return APP_MSG_NOT_CONNECTED;
+    }
+    mock_counters.messages_sent++;
+    mock_counters.outbox_bytes += outbox.size;
+    last_sent        = outbox;
+    outbox_in_flight = true;
+    outbox_ack_ms    = clock_ms + OUTBOX_ACK_MS;
+    return APP_MSG_OK;
+}
+
+static uint64_t outbox_ack_due(void) {
+    return outbox_in_flight ? outbox_ack_ms : UINT64_MAX;
+}
+
+// Wakes the app only if it asked to hear about it.
+static void deliver_outbox_ack(void) {
+    outbox_in_flight = false;
+    if(outbox_sent_handler != NULL) {
+        mock_counters.wakeups++;
+        outbox_sent_handler(&last_sent, NULL);
+        render_if_dirty();
+    }
+}
+
+bool mock_sent_uint32(uint32_t key, uint32_t *value) {
+    Tuple *tuple = dict_find(&last_sent, key);
+
+    if(tuple == NULL || tuple->type != TUPLE_UINT) {
+        return false;
+    }
+    *value = tuple->value->uint32;
+    return true;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+    inbox_size  = size_inbound;
+    outbox_size = size_outbound;
+    mock_free(message_buffers);
+    message_buffers = mock_alloc(size_inbound + size_outbound);
+    return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+    AppMessageInboxReceived previous = inbox_received_handler;
+
+    inbox_received_handler = received_callback;
+    return previous;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+    AppMessageOutboxSent previous = outbox_sent_handler;
+
+    outbox_sent_handler = sent_callback;
+    return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+    AppMessageOutboxFailed previous = outbox_failed_handler;
+
+    outbox_failed_handler = failed_callback;
+    return previous;
+}
+
+void app_message_deregister_callbacks(void) {
+    inbox_received_handler = NULL;
+    outbox_sent_handler    = NULL;
+    outbox_failed_handler  = NULL;
+}
+
+// Background worker.  It does not run on the host; the app can only start it
+// and talk to it.
+static bool worker_running;
+
+AppWorkerResult app_worker_launch(void) {
+    if(worker_running) {
+        return APP_WORKER_RESULT_ALREADY_RUNNING;
+    }
+    worker_running = true;
+    return APP_WORKER_RESULT_SUCCESS;
+}
+
+bool app_worker_is_running(void) {
+    return worker_running;
+}
+
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data) {
+}
+
+void mock_app_message(const uint32_t *keys, const uint32_t *values, int count) {
+    DictionaryIterator iter;
+    int                i;
+
+    // The phone's message is received (and costs a wakeup) only if the app
+    // opened an inbox large enough for it and registered a handler.
+    if(inbox_received_handler == NULL || count > DICT_TUPLES_MAX) {
+        return;
+    }
+    mock_counters.wakeups++;
+    if(dict_calc_buffer_size(0) + count * (7 + sizeof(uint32_t)) > inbox_size) {
+        mock_counters.messages_dropped++;
+        return;
+    }
+    iter.count = count;
+    for(i = 0; i < count; i++) {
+        Tuple *tuple = (Tuple *)iter.storage[i];
+
+        tuple->key           = keys[i];
+        tuple->type          = TUPLE_INT;
+        tuple->length        = sizeof(uint32_t);
+        tuple->value->uint32 = values[i];
+    }
+    mock_counters.messages++;
+    inbox_received_handler(&iter, NULL);
+    render_if_dirty();
+}
+
+// Persistent storage: a handful of fixed-size slots standing in for flash.
+#define PERSIST_SLOTS 32
+
+typedef struct PersistSlot {
+    bool     used;
+    uint32_t key;
+    size_t   size;
+    uint8_t  data[PERSIST_DATA_MAX_LENGTH];
+} PersistSlot;
+
+// Mapped shared so that flash survives across the processes of a
+// multi-launch trace, as it survives an app exit on the watch.
+static PersistSlot *persist_slots;
+
+void mock_persist_clear(void) {
+    if(persist_slots == NULL) {
+        persist_slots = mmap(NULL, PERSIST_SLOTS * sizeof(PersistSlot), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(persist_slots == MAP_FAILED) {
+            perror("mmap");
+            abort();
+        }
+    }
+    memset(persist_slots, 0, PERSIST_SLOTS * sizeof(PersistSlot));
+}
+
+static PersistSlot *persist_find(uint32_t key, bool create) {
+    int i;
+
+    for(i = 0; i < PERSIST_SLOTS; i++) {
+        if(persist_slots[i].used && persist_slots[i].key == key) {
+            return &persist_slots[i];
+        }
+    }
+    if(!create) {
+        return NULL;
+    }
+    for(i = 0; i < PERSIST_SLOTS; i++) {
+        if(!persist_slots[i].used) {
+            persist_slots[i].used = true;
+            persist_slots[i].key  = key;
+            return &persist_slots[i];
+        }
+    }
+    return NULL;
+}
+
+bool persist_exists(uint32_t key) {
+    mock_counters.persist_reads++;
+    return persist_find(key, false) != NULL;
+}
+
+int32_t persist_read_int(uint32_t key) {
+    int32_t value = 0;
+
+    persist_read_data(key, &value, sizeof(value));
+    return value;
+}
+
+int persist_write_int(uint32_t key, int32_t value) {
+    return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size) {
+    PersistSlot *slot = persist_find(key, false);
+    size_t      size;
+
+    mock_counters.persist_reads++;
+    if(slot == NULL) {
+        return -1;
+    }
+    size = slot->size < buffer_size ? slot->size : buffer_size;
+    memcpy(buffer, slot->data, size);
+    return (int)size;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size) {
+    PersistSlot *slot;
+
+    mock_counters.persist_writes++;
+    if(size > PERSIST_DATA_MAX_LENGTH || (slot = persist_find(key, true)) == NULL) {
+        return -1;
+    }
+    slot->size = size;
+    memcpy(slot->data, data, size);
+    return (int)size;
+}
+
+int persist_delete(uint32_t key) {
+    PersistSlot *slot = persist_find(key, false);
+
+    // Erasing a record is a flash write too.
+    mock_counters.persist_writes++;
+    if(slot == NULL) {
+        return -1;
+    }
+    slot->used = false;
+    return 0;
+}
+
+// Event loop.
+static void (*event_loop)(void);
+
+void mock_set_event_loop(void (*loop)(void)) {
+    event_loop = loop;
+}
+
+uint32_t mock_app_exit(void) {
+    // The OS owns the AppMessage buffers; anything else still live has leaked.
+    mock_free(message_buffers);
+    message_buffers = NULL;
+    tick_handler      = NULL;
+    memset(app_timers, 0, sizeof(app_timers));
+    battery_handler   = NULL;
+    bluetooth_handler = NULL;
+    inbox_received_handler = NULL;
+    outbox_open       = false;
+    outbox_in_flight  = false;
+    outbox_sent_handler   = NULL;
+    outbox_failed_handler = NULL;
+    last_sent.count   = 0;
+    top_window        = NULL;
+    window_dirty      = false;
+    return mock_counters.heap_bytes;
+}
+
+void app_event_loop(void) {
+    // Whatever do_init() dirtied is drawn before the first event arrives.
+    render_if_dirty();
+    if(event_loop != NULL) {
+        event_loop();
+    }
+}
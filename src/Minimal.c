@@ -1,21 +1,50 @@
 #include <pebble.h>
 
-// Necessary AppSync variables.
-AppSync sync;
-uint8_t sync_buffer[96];
+#include "drain_log.h"
 
 // App-specific data
 Window        *window;        // All apps must have at least one window
-TextLayer     *time_layer;    // The clock
+Layer         *number_layer;  // The clock, drawn from the digit atlas.
 TextLayer     *month_layer;   // The month
 TextLayer     *weather_layer; // The weather, eventually. Right now the day of the week.
 Layer         *hand_layer;    // The hand layer we use to update the hands.
-GPoint        center;         // Point of the center of the screen
+Layer         *frame_layer;   // On top of the rest: keeps a copy of each new frame for the next launch.
+
+// Screen layout, fixed per platform at build time.  aplite, basalt and diorite share the 144x168 rectangle; chalk is
+// round, so the date goes at the top and the day of the week at the bottom, where the corners would be off screen.
+#if defined(PBL_ROUND)
+#define SCREEN_WIDTH      180
+#define SCREEN_HEIGHT     180
+#define MONTH_FRAME       GRect(SCREEN_WIDTH / 2 - 45, 8, 90, 18)
+#define MONTH_ALIGNMENT   GTextAlignmentCenter
+#define WEEKDAY_FRAME     GRect(SCREEN_WIDTH / 2 - 30, SCREEN_HEIGHT - 26, 60, 18)
+#define WEEKDAY_ALIGNMENT GTextAlignmentCenter
+#else
+#define SCREEN_WIDTH      144
+#define SCREEN_HEIGHT     168
+#define MONTH_FRAME       GRect(2, SCREEN_HEIGHT - 18, 60, 18)
+#define MONTH_ALIGNMENT   GTextAlignmentLeft
+#define WEEKDAY_FRAME     GRect(SCREEN_WIDTH - 36, SCREEN_HEIGHT - 18, 34, 18)
+#define WEEKDAY_ALIGNMENT GTextAlignmentRight
+#endif
+#define SCREEN_FRAME      GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT)
+#define TIME_FRAME        GRect((SCREEN_WIDTH - 50) / 2, (SCREEN_HEIGHT - 50) / 2, 50, 50)
+
+static const GPoint center = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 }; // Point of the center of the screen
+
+//Custom fonts, loaded on first use and shared by every layer that draws with them.
+static struct {
+    uint32_t resource_id;
+    GFont    font;
+} fonts[] = {
+    { RESOURCE_ID_FONT_MAIN_40,  NULL },
+    { RESOURCE_ID_FONT_LOWER_15, NULL }
+};
 
 const char    DAYS_OF_WEEK[7][3] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
 const char    MONTH_NAMES[12][3] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
-//enum for key data with AppSync.
+//enum for key data with AppMessage.  The option keys double as their bit numbers in CONFIG_KEY.
 enum {
     BLUETOOTH_VIBE_KEY  = 0x0,
     HOURLY_VIBE_KEY     = 0x1,
@@ -23,9 +52,26 @@ enum {
     CHARGE_BLINK_KEY    = 0x3,
     INVERTED_COLORS_KEY = 0x4,
     MINUTE_HANDS_KEY    = 0x5,
-    STORAGE_VERSION_KEY = 0x10
+    CONFIG_KEY          = 0x6,  // All the options packed into one uint32.
+    STATS_KEY           = 0x7,  // Sent to the phone by builds with MINIMAL_STATS.
+    POWER_SAVE_KEY      = 0x8,  // Low battery threshold in percent, 0 for off.  A byte of CONFIG_KEY, not a bit.
+    DRAIN_LOG_KEY       = 0x9,  // Sent to the phone by builds with MINIMAL_STATS: a batch of the battery log.
+    STORAGE_VERSION_KEY = 0x10, // To the phone: the options the watch has, packed like CONFIG_KEY.  From the phone:
+                                // a request for them.
+    OPTIONS_KEY         = 0x11, // Persistent storage only: the whole options record.
+    FRAME_KEY           = 0x12, // Persistent storage only: what the last frame showed.  Its pixels follow in the
+                                // FRAME_CHUNKS keys from FRAME_CHUNK_KEY.
+    FRAME_CHUNK_KEY     = 0x13
 };
 
+//CONFIG_KEY carries one bit per on/off option, the low battery threshold in the second byte and the format version
+//in the top byte.  Clients that predate it send one int per option key instead.  The watch reports its own options
+//the same way when the phone asks, and the phone only sends them if they differ.
+#define CONFIG_VERSION          1
+#define CONFIG_VERSION_SHIFT    24
+#define CONFIG_POWER_SAVE_SHIFT 8
+#define OPTION_COUNT            7
+
 //Struct for using and storing options for the user.
 struct Persist {
     int bluetooth_vibe;
@@ -35,14 +81,199 @@ struct Persist {
     int inverted_colors;
     int minute_hands;
     int storage_version;
+    int power_save;
 };
 
 struct Persist options;
 
+//The options as written to flash.  storage_version 2 and earlier kept one int per key instead.
+#define OPTIONS_VERSION 3
+
+struct PersistRecord {
+    struct Persist options;
+    uint32_t       checksum;
+};
+
+static bool optionsDirty; // The options differ from what is in flash.
+
+#ifdef MINIMAL_STATS
+//Field statistics (waf build --stats), to tell how much of the battery the face itself uses.  They count from launch
+//and go to the phone as one STATS_KEY byte array, little-endian uint32s in this order, every STATS_PERIOD_MIN
+//minutes; a push that does not arrive is simply covered by the next one.
+#define STATS_PERIOD_MIN 60
+
+static struct {
+    uint32_t minutes;      // Since launch.
+    uint32_t hand_updates;
+    uint32_t draw_ms;      // Total time spent in hand_update.
+    uint32_t draw_ms_max;
+    uint32_t minute_ticks; // Tick callbacks while subscribed by the minute.
+    uint32_t hour_ticks;   // And by the hour, in low battery mode.
+    uint32_t gpath_builds;
+    uint32_t vibes;
+    uint32_t messages;     // Options messages from the phone.
+} stats;
+
+static time_t   stats_launch;
+static uint32_t stats_sent_minutes; // stats.minutes at the last push.
+
+#define STAT_ADD(field, n) (stats.field += (n))
+
+static uint32_t StatsNowMs() {
+    time_t   seconds;
+    uint16_t ms;
+
+    time_ms(&seconds, &ms);
+    return (uint32_t)seconds * 1000 + ms;
+}
+
+static void SendStats() {
+    DictionaryIterator *iter;
+
+    //Busy or out of reach: the totals go with the next push.
+    if(app_message_outbox_begin(&iter) != APP_MSG_OK) {
+        return;
+    }
+    dict_write_data(iter, STATS_KEY, (const uint8_t *)&stats, sizeof(stats));
+    app_message_outbox_send();
+}
+#else
+#define STAT_ADD(field, n)
+#endif
+
 // Control booleans
-static bool wasConnected;
+static bool wasConnected;  // The bluetooth state the user was last told about.
+static bool bluetoothDropped; // The link went down since the state last settled.
 static bool blackCharging; // Used for flashing the hand while charging.  Only true if isCharging is true.
 static bool isCharging;
+static bool powerSaving;   // Low battery mode: hourly ticks, no minutes on screen, no hourly vibe.
+
+#ifdef MINIMAL_STATS
+//The background worker logs the battery (see drain_log.h).  The face tells it the mode to log the samples under and
+//sends the log to the phone a batch at a time, each as DRAIN_LOG_KEY: the little-endian number of its first sample,
+//then the samples.  A batch counts as exported once the phone acknowledges it; the next one goes as soon as the
+//outbox is free, and a failed one is tried again after the next reconnect.
+static uint32_t drain_exported;       // Samples the phone has acknowledged.
+static uint32_t drain_exported_saved; // As in flash.
+static uint32_t drain_sending;        // Samples in the message in flight.
+static bool     config_reply_pending; // The phone asked for the options while the outbox was busy.
+
+static void SendConfigRevision();
+
+static void SendDrainMode(bool foreground) {
+    AppWorkerMessage message = {
+        .data0 = (options.bluetooth_vibe & 1) << BLUETOOTH_VIBE_KEY | (options.hourly_vibe & 1) << HOURLY_VIBE_KEY |
+                 (options.battery_hand & 1) << BATTERY_HAND_KEY | (options.charge_blink & 1) << CHARGE_BLINK_KEY |
+                 (options.inverted_colors & 1) << INVERTED_COLORS_KEY | (options.minute_hands & 1) << MINUTE_HANDS_KEY |
+                 (powerSaving ? DRAIN_MODE_POWER_SAVE : 0) | (foreground ? DRAIN_MODE_FOREGROUND : 0)
+    };
+
+    app_worker_send_message(DRAIN_MODE_MESSAGE, &message);
+}
+
+//Sends the next batch of samples the phone has not had, if the outbox is free.
+static void ExportDrainLog() {
+    DrainLogState      state;
+    DrainSample        chunk[DRAIN_LOG_CHUNK_SAMPLES];
+    uint8_t            batch[sizeof(uint32_t) + DRAIN_LOG_BATCH * sizeof(DrainSample)];
+    uint32_t           first, count;
+    uint32_t           oldest;
+    DictionaryIterator *iter;
+
+    if(drain_sending > 0 || persist_read_data(DRAIN_LOG_STATE_KEY, &state, sizeof(state)) != (int)sizeof(state)) {
+        return;
+    }
+    //A log started over (the watch was wiped), or samples the worker has since written over.  Starting a chunk
+    //clears it, so the oldest sample left is the first of the chunk after the one being filled.
+    oldest = (state.count + DRAIN_LOG_CHUNK_SAMPLES - 1) / DRAIN_LOG_CHUNK_SAMPLES;
+    oldest = oldest > DRAIN_LOG_CHUNKS ? (oldest - DRAIN_LOG_CHUNKS) * DRAIN_LOG_CHUNK_SAMPLES : 0;
+    if(drain_exported > state.count) {
+        drain_exported = 0;
+    }
+    if(drain_exported < oldest) {
+        drain_exported = oldest;
+    }
+
+    //A batch never spans two chunks.
+    first = drain_exported % DRAIN_LOG_CHUNK_SAMPLES;
+    count = state.count - drain_exported;
+    count = count < DRAIN_LOG_BATCH ? count : DRAIN_LOG_BATCH;
+    count = count < DRAIN_LOG_CHUNK_SAMPLES - first ? count : DRAIN_LOG_CHUNK_SAMPLES - first;
+    if(count == 0 ||
+       persist_read_data(DRAIN_LOG_CHUNK_KEY + drain_exported / DRAIN_LOG_CHUNK_SAMPLES % DRAIN_LOG_CHUNKS, chunk, sizeof(chunk)) <
+       (int)((first + count) * sizeof(DrainSample))) {
+        return;
+    }
+    if(app_message_outbox_begin(&iter) != APP_MSG_OK) {
+        return;
+    }
+    memcpy(batch, &drain_exported, sizeof(drain_exported));
+    memcpy(batch + sizeof(drain_exported), &chunk[first], count * sizeof(DrainSample));
+    dict_write_data(iter, DRAIN_LOG_KEY, batch, sizeof(drain_exported) + count * sizeof(DrainSample));
+    if(app_message_outbox_send() == APP_MSG_OK) {
+        drain_sending = count;
+    }
+}
+
+static void outbox_sent(DictionaryIterator *iter, void *context) {
+    drain_exported += drain_sending;
+    drain_sending   = 0;
+    //The phone only sends its options once it has the answer, so that goes before the next batch.
+    if(config_reply_pending) {
+        SendConfigRevision();
+        return;
+    }
+    ExportDrainLog();
+}
+
+static void outbox_failed(DictionaryIterator *iter, AppMessageResult reason, void *context) {
+    drain_sending = 0;
+    if(config_reply_pending) {
+        SendConfigRevision();
+    }
+}
+
+#define DRAIN_MODE_CHANGED() SendDrainMode(true)
+//The drain log can hold the outbox for a while, so an answer that finds it busy is sent from outbox_sent.
+#define CONFIG_REPLY_PENDING(pending) (config_reply_pending = (pending))
+#else
+#define DRAIN_MODE_CHANGED()
+#define CONFIG_REPLY_PENDING(pending)
+#endif
+
+// The time as of the last tick (or resync).  Everything on screen is drawn from this rather than by reading the clock.
+static struct tm clock_time;
+
+// What the layers currently show.  Handlers work out what the screen should show and compare it against this, so
+// only the layers whose inputs changed are touched.
+static struct {
+    int     number;          // The centered number.
+    int     mday;
+    int     mon;
+    int     wday;
+    int32_t angle;           // Of the hand.
+    int     battery_level;
+    int     battery_hand;
+    int     inverted_colors;
+    bool    hidden;          // The hand is hidden by the charge blink, or because it shows the minutes in low battery mode.
+} shown = { .number = -2, .angle = -1, .battery_level = -1 };
+
+// Charge blink: the hand is hidden for CHARGE_BLINK_OFF_MS out of every CHARGE_BLINK_PERIOD_MS.  Each phase change
+// costs a wakeup, so a long period with a short off phase keeps the blink visible at a fraction of the old 1 Hz.
+static const uint32_t CHARGE_BLINK_PERIOD_MS = 4000;
+static const uint32_t CHARGE_BLINK_OFF_MS    = 1000;
+static AppTimer       *blink_timer;
+
+// Bluetooth changes are acted on once the link has been stable for BLUETOOTH_SETTLE_MS, so a flapping connection
+// gives one vibe and one resync.  After a reconnect the date and hand are refreshed, then checked again at doubling
+// intervals until the phone has stopped correcting the clock (e.g. after a flight across time zones).
+static const uint32_t BLUETOOTH_SETTLE_MS = 3000;
+static const uint32_t RESYNC_FIRST_MS     = 2000;
+static const int      RESYNC_ATTEMPTS     = 4;
+static AppTimer       *bluetooth_timer;
+static AppTimer       *resync_timer;
+static int            resync_attempt;
+static time_t         resync_expected; // When the clock should read at the next check if nobody changed it.
 
 // Variable for the hour hand.
 static const GPathInfo HOUR_HAND_POINTS =
@@ -56,78 +287,428 @@ static const GPathInfo HOUR_HAND_POINTS =
     }
 };
 
-// Array for displaying the correct battery state.
-static const GPathInfo BATTERY_POINTS[] = {
-    { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 30 }, { -4, 30 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 32 }, { -4, 32 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 34 }, { -4, 34 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 36 }, { -4,  36 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 38 }, { -4, 38 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 40 }, { -4, 40 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 42 }, { -4, 42 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 44 }, { -4, 44 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 46 }, { -4, 46 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 48 }, { -4, 48 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 50 }, { -4, 50 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 52 }, { -4, 52 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 54 }, { -4, 54 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 56 }, { -4, 56 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 58 }, { -4, 58 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 60 }, { -4, 60 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 62 }, { -4, 62 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 64 }, { -4, 64 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 66 }, { -4, 66 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 68 }, { -4, 68 } } }, { 4, (GPoint []) { { -4, 30 }, { 3, 30 }, { 3, 70 }, { -4, 70 } } }
-};
+// Points of the battery hands.  The hands grow out from the base of the hour hand by BATTERY_HAND_STEP pixels per
+// battery increment; only the two tip points move, and they are updated in place.
+static GPoint batt_points[]  = { { -4, 30 }, { 3, 30 }, { 3, 30 }, { -4, 30 } };
+//Second, narrower hand for pesky pixel problem.
+static GPoint batt_points2[] = { { -3, 30 }, { 2, 30 }, { 2, 30 }, { -3, 30 } };
 
-//Second array for pesky pixel problem.
-static const GPathInfo BATTERY_POINTS2[] = {
-    { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 30 }, { -3, 30 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 32 }, { -3, 32 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 34 }, { -3, 34 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 36 }, { -3,  36 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 38 }, { -3, 38 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 40 }, { -3, 40 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 42 }, { -3, 42 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 44 }, { -3, 44 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 46 }, { -3, 46 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 48 }, { -3, 48 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 50 }, { -3, 50 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 52 }, { -3, 52 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 54 }, { -3, 54 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 56 }, { -3, 56 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 58 }, { -3, 58 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 60 }, { -3, 60 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 62 }, { -3, 62 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 64 }, { -3, 64 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 66 }, { -3, 66 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 68 }, { -3, 68 } } }, { 4, (GPoint []) { { -3, 30 }, { 2, 30 }, { 2, 70 }, { -3, 70 } } }
-};
+static const GPathInfo BATTERY_POINTS  = { 4, batt_points };
+static const GPathInfo BATTERY_POINTS2 = { 4, batt_points2 };
+
+static int battery_level; // Battery increments the hands currently show.
 
-//Constant for the number of battery increments.
-static const int BATTERY_INCS = 20;
+//Constants for the number of battery increments and the length of the hand.
+static const int BATTERY_INCS      = 20;
+static const int BATTERY_HAND_BASE = 30;
+static const int BATTERY_HAND_STEP = 2;
 
 // GPaths for hands.
 static GPath *hour_hand;
 static GPath *batt_hand;
 static GPath *batt_hand2;
 
+#ifdef PBL_BW
+// The hand and the number are read back from the frame buffer the same way, and only on 1-bit screens.  Those are
+// also the only ones whose frame buffer is rows of equal length; chalk's round one is not.
+//
+// Is the pixel at x of the captured frame buffer row drawn in the color of the hand and the number?
+static bool is_drawn_pixel(const uint8_t *row, int x) {
+    return ((row[x / 8] >> (x % 8)) & 1) == (options.inverted_colors == 1 ? 0 : 1);
+}
+#endif
+
+// Horizontal runs of the last hand drawn, in hand layer coordinates.  They are read back from the frame buffer
+// right after the hand is rasterized, so redrawing the same hand (blink frames, redraws caused by other layers)
+// is a handful of rectangle fills instead of rotating and filling the GPaths again, and the pixels are exactly
+// the ones the firmware drew.  1-bit screens only: on color the outline is antialiased, and solid runs would drop
+// its blended edge pixels.
+#ifdef PBL_BW
+typedef struct {
+    int16_t y;
+    int16_t x;
+    int16_t w;
+} HandSpan;
+
+#define HAND_SPANS_MAX 128
+static HandSpan hand_spans[HAND_SPANS_MAX];
+static int      hand_span_count;
+static bool     hand_spans_valid;
+static GPath    *hand_span_path;   // The GPath that was filled, along with the outlined hour hand.
+static int32_t  hand_span_angle;
+static int      hand_span_inverted;
+#endif
+
 // Used to create the hour hand.
 static void CreateHourHand() {
     hour_hand = gpath_create(&HOUR_HAND_POINTS);
+    STAT_ADD(gpath_builds, 1);
     gpath_move_to(hour_hand, center);
 }
-// Used to create the battery hand.
-static void CreateBatteryHands(int charge_percent) {
-    if((BATTERY_INCS * charge_percent) / 90 > BATTERY_INCS) {
-        batt_hand  = gpath_create(&BATTERY_POINTS[BATTERY_INCS]);
-        batt_hand2 = gpath_create(&BATTERY_POINTS2[BATTERY_INCS]);
-    } else {
-        batt_hand  = gpath_create(&BATTERY_POINTS[(BATTERY_INCS * charge_percent) / 100]);
-        batt_hand2 = gpath_create(&BATTERY_POINTS2[(BATTERY_INCS * charge_percent) / 100]);
-    }
+// Used to create the battery hands.  They live until do_deinit; UpdateBatteryHands changes their length.
+static void CreateBatteryHands() {
+    batt_hand  = gpath_create(&BATTERY_POINTS);
+    batt_hand2 = gpath_create(&BATTERY_POINTS2);
+    STAT_ADD(gpath_builds, 2);
     gpath_move_to(batt_hand, center);
     gpath_move_to(batt_hand2, center);
 }
 
-//Used to update the center numbers.
-static void update_number(int number) {
-    static char time_text[] = "00"; // Needs to be static because it's used by the system later.
+// The battery hand's length for the charge, in increments.
+static int BatteryLevel(int charge_percent) {
+    return (BATTERY_INCS * (charge_percent > 100 ? 100 : charge_percent)) / 100;
+}
+
+// Used to set the length of the battery hands for the charge.
+static void UpdateBatteryHands(int charge_percent) {
+    int     level = BatteryLevel(charge_percent);
+    int16_t tip   = BATTERY_HAND_BASE + BATTERY_HAND_STEP * level;
+
+    //Most battery events don't change the length of the hand.
+    if(level == battery_level) {
+        return;
+    }
+    battery_level     = level;
+    batt_points[2].y  = tip;
+    batt_points[3].y  = tip;
+    batt_points2[2].y = tip;
+    batt_points2[3].y = tip;
+
+#ifdef PBL_BW
+    // The captured hand may have been drawn at the old length.
+    hand_spans_valid = false;
+#endif
+}
+
+#ifdef PBL_BW
+// Records the hand that was just drawn on layer as runs of hand-colored pixels.
+static void capture_hand_spans(GContext *ctx, Layer *layer) {
+    GRect   frame        = layer_get_frame(layer);
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    int     x, y, start;
+
+    hand_spans_valid = false;
+    if(frame_buffer == NULL) {
+        return;
+    }
+    hand_span_count = 0;
+    for(y = 0; y < frame.size.h; y++) {
+        const uint8_t *row = gbitmap_get_data(frame_buffer) + (frame.origin.y + y) * gbitmap_get_bytes_per_row(frame_buffer);
+
+        for(x = frame.origin.x; x < frame.origin.x + frame.size.w; x++) {
+            if(!is_drawn_pixel(row, x)) {
+                continue;
+            }
+            //Too many runs to be worth caching; keep using the GPaths.
+            if(hand_span_count == HAND_SPANS_MAX) {
+                graphics_release_frame_buffer(ctx, frame_buffer);
+                return;
+            }
+            start = x;
+            while(x < frame.origin.x + frame.size.w && is_drawn_pixel(row, x)) {
+                x++;
+            }
+            hand_spans[hand_span_count++] = (HandSpan) { y, start - frame.origin.x, x - start };
+        }
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    hand_spans_valid = true;
+}
+#endif
+
+// Fills fill_path and outlines the hour hand, from the span cache when it holds this exact hand.
+static void draw_hand(Layer *layer, GContext *ctx, GPath *fill_path, int32_t rotationAngle) {
+#ifdef PBL_BW
+    if(hand_spans_valid && hand_span_path == fill_path && hand_span_angle == rotationAngle && hand_span_inverted == options.inverted_colors) {
+        for(int i = 0; i < hand_span_count; i++) {
+            graphics_fill_rect(ctx, GRect(hand_spans[i].x, hand_spans[i].y, hand_spans[i].w, 1), 0, GCornerNone);
+        }
+        return;
+    }
+#endif
+
+    gpath_rotate_to(fill_path, rotationAngle);
+    gpath_draw_filled(ctx, fill_path);
+    gpath_draw_outline(ctx, hour_hand);
+
+#ifdef PBL_BW
+    //The minute hand moves every minute, so capturing it only pays while the charge blink redraws it in between.
+    if(options.minute_hands == 1 && blink_timer == NULL) {
+        return;
+    }
+    capture_hand_spans(ctx, layer);
+    hand_span_path     = fill_path;
+    hand_span_angle    = rotationAngle;
+    hand_span_inverted = options.inverted_colors;
+#endif
+}
+
+// Returns the font for a resource, loading it the first time it is asked for.
+static GFont GetFont(uint32_t resource_id) {
+    for(size_t i = 0; i < ARRAY_LENGTH(fonts); i++) {
+        if(fonts[i].resource_id == resource_id) {
+            if(fonts[i].font == NULL) {
+                fonts[i].font = fonts_load_custom_font(resource_get_handle(resource_id));
+            }
+            return fonts[i].font;
+        }
+    }
+    return NULL;
+}
+
+// Unloads a font if it is loaded.  Only once nothing draws with it any more.
+static void UnloadFont(uint32_t resource_id) {
+    for(size_t i = 0; i < ARRAY_LENGTH(fonts); i++) {
+        if(fonts[i].resource_id == resource_id && fonts[i].font != NULL) {
+            fonts_unload_custom_font(fonts[i].font);
+            fonts[i].font = NULL;
+        }
+    }
+}
+
+// Unloads every font that was loaded.
+static void UnloadFonts() {
+    for(size_t i = 0; i < ARRAY_LENGTH(fonts); i++) {
+        UnloadFont(fonts[i].resource_id);
+    }
+}
+
+// The centered number is drawn from an atlas of the ten digits rather than set as text.  On the first frame each
+// digit is set once in FONT_MAIN_40 and read back from the frame buffer as a 1-bit mask of the rows it inks, then the
+// font is unloaded; from there on a number is one or two blits.  Digits are placed as the font sets them: as wide as
+// each is on its own, digit_spacing apart, and centered.  1-bit screens only: color text is antialiased, which a mask
+// cannot hold, so color screens set the number as text.
+static GColor number_color() {
+    return options.inverted_colors == 1 ? GColorBlack : GColorWhite;
+}
+
+#ifdef PBL_BW
+typedef struct {
+    uint8_t *mask;   // rows * stride bytes, LSB first.
+    int16_t width;
+    int16_t top;     // First inked row.
+    int16_t rows;
+    int16_t stride;
+} DigitGlyph;
 
-    // Change the number display.
-    time_text[0] = '0' + (number / 10);
-    if(time_text[0] == '0') {
-        time_text[0] = '0' + number;
-        time_text[1] = '\0';
+static DigitGlyph digits[10];
+static int16_t    digit_spacing;
+static bool       digits_ready;
+static bool       digits_tried; // RasterizeDigits has run.  A failure is not retried; the number is set as text.
+
+static void set_number_pixel(uint8_t *row, int x) {
+    if(options.inverted_colors == 1) {
+        row[x / 8] &= ~(1 << (x % 8));
     } else {
-        time_text[1] = '0' + (number % 10);
+        row[x / 8] |= 1 << (x % 8);
     }
-    text_layer_set_text(time_layer, time_text);
 }
 
-// Update the hands and redraw them.
-static void hand_update(Layer *layer, GContext *ctx) {
-    // Get the current time.
-    time_t    now = time(NULL);
-    struct tm *t  = localtime(&now);
-    int       rotationAngle;
-    //Update the centered number.
-    update_number(options.minute_hands == 0 ? t->tm_min : (clock_is_24h_style() ? t->tm_hour : ((t->tm_hour + 11) % 12) + 1));
-
-    // Get the rotation angle.
+static void FreeDigits() {
+    for(int d = 0; d < 10; d++) {
+        free(digits[d].mask);
+        digits[d].mask = NULL;
+    }
+    digits_ready = false;
+}
+
+// Reads the digit just set at the top left of the layer's frame into its atlas entry.
+static bool capture_digit(GContext *ctx, GRect frame, DigitGlyph *digit) {
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    int     top = -1, bottom = -1, x, y;
+
+    if(frame_buffer == NULL) {
+        return false;
+    }
+    for(y = 0; y < frame.size.h; y++) {
+        const uint8_t *row = gbitmap_get_data(frame_buffer) + (frame.origin.y + y) * gbitmap_get_bytes_per_row(frame_buffer);
+
+        for(x = 0; x < digit->width; x++) {
+            if(is_drawn_pixel(row, frame.origin.x + x)) {
+                top    = top < 0 ? y : top;
+                bottom = y;
+                break;
+            }
+        }
+    }
+    digit->top    = top < 0 ? 0 : top;
+    digit->rows   = top < 0 ? 0 : bottom - top + 1;
+    digit->stride = (digit->width + 7) / 8;
+    digit->mask   = digit->rows > 0 ? malloc(digit->rows * digit->stride) : NULL;
+    if(digit->rows > 0 && digit->mask == NULL) {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return false;
+    }
+    if(digit->mask != NULL) {
+        memset(digit->mask, 0, digit->rows * digit->stride);
+    }
+    for(y = 0; y < digit->rows; y++) {
+        const uint8_t *row = gbitmap_get_data(frame_buffer) + (frame.origin.y + digit->top + y) * gbitmap_get_bytes_per_row(frame_buffer);
+
+        for(x = 0; x < digit->width; x++) {
+            if(is_drawn_pixel(row, frame.origin.x + x)) {
+                digit->mask[y * digit->stride + x / 8] |= 1 << (x % 8);
+            }
+        }
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return true;
+}
+
+// Copies the frame buffer rows the layer covers to or from saved.
+static bool swap_rows(GContext *ctx, GRect frame, uint8_t *saved, bool restore) {
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    uint8_t *rows;
+    size_t  size;
+
+    if(frame_buffer == NULL) {
+        return false;
+    }
+    rows = gbitmap_get_data(frame_buffer) + frame.origin.y * gbitmap_get_bytes_per_row(frame_buffer);
+    size = frame.size.h * gbitmap_get_bytes_per_row(frame_buffer);
+    memcpy(restore ? rows : saved, restore ? saved : rows, size);
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return true;
+}
+
+// Sets each digit on a cleared layer and captures it, then puts back what the layers below had drawn.  Leaves
+// digits_ready false if the atlas could not be built, and the number is then set as text.
+static void RasterizeDigits(Layer *layer, GContext *ctx) {
+    GFont   font   = GetFont(RESOURCE_ID_FONT_MAIN_40);
+    GRect   frame  = layer_get_frame(layer);
+    GRect   box    = GRect(0, 0, frame.size.w, frame.size.h);
+    char    text[] = "00";
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    uint8_t *saved;
+
+    if(frame_buffer == NULL) {
+        return;
+    }
+    saved = malloc(frame.size.h * gbitmap_get_bytes_per_row(frame_buffer));
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    if(saved == NULL || !swap_rows(ctx, frame, saved, false)) {
+        free(saved);
+        return;
+    }
+
+    //The spacing is whatever a pair of digits takes over the two on their own.
+    digit_spacing = graphics_text_layout_get_content_size(text, font, box, GTextOverflowModeWordWrap, GTextAlignmentLeft).w;
+    text[1]       = '\0';
+    graphics_context_set_text_color(ctx, number_color());
+    graphics_context_set_fill_color(ctx, options.inverted_colors == 1 ? GColorWhite : GColorBlack);
+    for(int d = 0; d < 10; d++) {
+        text[0]         = '0' + d;
+        digits[d].width = graphics_text_layout_get_content_size(text, font, box, GTextOverflowModeWordWrap, GTextAlignmentLeft).w;
+        digits[d].width = digits[d].width < frame.size.w ? digits[d].width : frame.size.w;
+        graphics_fill_rect(ctx, box, 0, GCornerNone);
+        graphics_draw_text(ctx, text, font, box, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+        if(!capture_digit(ctx, frame, &digits[d])) {
+            FreeDigits();
+            break;
+        }
+        digits_ready = d == 9;
+    }
+    swap_rows(ctx, frame, saved, true);
+    free(saved);
+    if(digits_ready) {
+        digit_spacing -= 2 * digits[0].width;
+        UnloadFont(RESOURCE_ID_FONT_MAIN_40);
+    }
+}
+
+// Copies a digit's mask into the frame buffer, its top left at x, y.
+static void blit_digit(GBitmap *frame_buffer, int x, int y, const DigitGlyph *digit) {
+    for(int r = 0; r < digit->rows; r++) {
+        uint8_t       *row  = gbitmap_get_data(frame_buffer) + (y + digit->top + r) * gbitmap_get_bytes_per_row(frame_buffer);
+        const uint8_t *mask = digit->mask + r * digit->stride;
+
+        for(int c = 0; c < digit->width; c++) {
+            if((mask[c / 8] >> (c % 8)) & 1) {
+                set_number_pixel(row, x + c);
+            }
+        }
+    }
+}
+
+// Blits the number whose digits are place[0 .. count - 1], centered on the layer's frame.
+static void blit_number(GContext *ctx, GRect frame, const int *place, int count) {
+    int     width = count == 2 ? digits[place[0]].width + digit_spacing + digits[place[1]].width : digits[place[0]].width;
+    int     x     = frame.origin.x + (frame.size.w - width) / 2;
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+
+    if(frame_buffer == NULL) {
+        return;
+    }
+    for(int i = 0; i < count; i++) {
+        blit_digit(frame_buffer, x, frame.origin.y, &digits[place[i]]);
+        x += digits[place[i]].width + digit_spacing;
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+}
+#else
+static void FreeDigits() {
+}
+#endif
+
+// Draws the centered number, shown.number.  A negative number leaves it blank.
+static void number_update(Layer *layer, GContext *ctx) {
+    GRect frame  = layer_get_frame(layer);
+    int   number = shown.number;
+    int   place[2];
+    int   count;
+
+#ifdef PBL_BW
+    if(!digits_tried) {
+        digits_tried = true;
+        RasterizeDigits(layer, ctx);
+    }
+#endif
+    if(number < 0) {
+        return;
+    }
+    count    = number >= 10 ? 2 : 1;
+    place[0] = number >= 10 ? number / 10 : number;
+    place[1] = number % 10;
+
+#ifdef PBL_BW
+    if(digits_ready) {
+        blit_number(ctx, frame, place, count);
+        return;
+    }
+#endif
+
+    //Without the atlas the number is set as text.
+    char text[] = { '0' + place[0], '0' + place[1], '\0' };
+
+    text[count] = '\0';
+    graphics_context_set_text_color(ctx, number_color());
+    graphics_draw_text(ctx, text, GetFont(RESOURCE_ID_FONT_MAIN_40), GRect(0, 0, frame.size.w, frame.size.h),
+                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
+// The angle the hand points at for the time t.
+static int32_t hand_angle(struct tm *t) {
     if(options.minute_hands == 1) {
-        rotationAngle = ((TRIG_MAX_ANGLE) / 60 * (t->tm_min + 30));
+        return ((TRIG_MAX_ANGLE) / 60 * (t->tm_min + 30));
     } else {
-        rotationAngle = ((TRIG_MAX_ANGLE) / 12 * ((t->tm_hour % 12) + 6));
+        return ((TRIG_MAX_ANGLE) / 12 * ((t->tm_hour % 12) + 6));
     }
+}
+
+// Redraw the hands.
+static void hand_update(Layer *layer, GContext *ctx) {
+    // Get the rotation angle of the hand that was invalidated.
+    int32_t rotationAngle = shown.angle;
+#ifdef MINIMAL_STATS
+    uint32_t draw_start = StatsNowMs();
+#endif
+
     //Rotate the "hour" hand always.
     gpath_rotate_to(hour_hand, rotationAngle);
 
     // If we are charging, then we pick the color based on blackCharging.  Then we draw.
-    if(blackCharging) {
-        blackCharging = false; //Set to false for next time.
+    if(shown.hidden) {
+        // The hand is hidden for this phase of the blink, or until the minutes show again.
     } else {
         if(options.inverted_colors == 1) {
             graphics_context_set_stroke_color(ctx, GColorBlack);
@@ -141,295 +722,737 @@ static void hand_update(Layer *layer, GContext *ctx) {
         if(options.battery_hand == 1) {
             //Depending on the rotation angle, we load one of the battery hands.
             if(rotationAngle - TRIG_MAX_ANGLE / 2 < TRIG_MAX_ANGLE / 16 || rotationAngle + TRIG_MAX_ANGLE / 8 > (3 * TRIG_MAX_ANGLE / 2) || (rotationAngle + TRIG_MAX_ANGLE / 8 > TRIG_MAX_ANGLE && rotationAngle < TRIG_MAX_ANGLE + TRIG_MAX_ANGLE / 16)) {
-                gpath_rotate_to(batt_hand, rotationAngle);
-                gpath_draw_filled(ctx, batt_hand);
+                draw_hand(layer, ctx, batt_hand, rotationAngle);
             } else {
-                gpath_rotate_to(batt_hand2, rotationAngle);
-                gpath_draw_filled(ctx, batt_hand2);
+                draw_hand(layer, ctx, batt_hand2, rotationAngle);
             }
         } else {
-            gpath_draw_filled(ctx, hour_hand);
+            draw_hand(layer, ctx, hour_hand, rotationAngle);
         }
-        gpath_draw_outline(ctx, hour_hand);
     }
+#ifdef MINIMAL_STATS
+    uint32_t elapsed = StatsNowMs() - draw_start;
+
+    STAT_ADD(hand_updates, 1);
+    STAT_ADD(draw_ms, elapsed);
+    if(elapsed > stats.draw_ms_max) {
+        stats.draw_ms_max = elapsed;
+    }
+#endif
 }
 
-// Called once per minute while the watch is not charging.
-static void handle_minute_tick(struct tm* tick_time, TimeUnits units_changed) {
+//Used to update the month, day and day of the week.
+static void update_date(struct tm *t) {
     static char month_text[]    = "000 00";
     static char day_week_text[] = "000";
 
-    //If the day changed, we update day, month, and day of the week.
-    if(units_changed & DAY_UNIT) {
-        month_text[4] = '0' + (tick_time->tm_mday / 10);
-        if(month_text[4] == '0') {
-            month_text[4] = '0' + tick_time->tm_mday;
-            month_text[5] = '\0';
-        } else {
-            month_text[5] = '0' + (tick_time->tm_mday % 10);
-        }
+    month_text[4] = '0' + (t->tm_mday / 10);
+    if(month_text[4] == '0') {
+        month_text[4] = '0' + t->tm_mday;
+        month_text[5] = '\0';
+    } else {
+        month_text[5] = '0' + (t->tm_mday % 10);
+    }
 
-        month_text[0] = MONTH_NAMES[tick_time->tm_mon][0];
-        month_text[1] = MONTH_NAMES[tick_time->tm_mon][1];
-        month_text[2] = MONTH_NAMES[tick_time->tm_mon][2];
+    month_text[0] = MONTH_NAMES[t->tm_mon][0];
+    month_text[1] = MONTH_NAMES[t->tm_mon][1];
+    month_text[2] = MONTH_NAMES[t->tm_mon][2];
 
-        day_week_text[0] = DAYS_OF_WEEK[tick_time->tm_wday][0];
-        day_week_text[1] = DAYS_OF_WEEK[tick_time->tm_wday][1];
-        day_week_text[2] = DAYS_OF_WEEK[tick_time->tm_wday][2];
+    day_week_text[0] = DAYS_OF_WEEK[t->tm_wday][0];
+    day_week_text[1] = DAYS_OF_WEEK[t->tm_wday][1];
+    day_week_text[2] = DAYS_OF_WEEK[t->tm_wday][2];
 
-        text_layer_set_text(month_layer, month_text);
-        text_layer_set_text(weather_layer, day_week_text);
-    }
+    text_layer_set_text(month_layer, month_text);
+    text_layer_set_text(weather_layer, day_week_text);
+}
 
-    //If the user wants hourly vibes, give it to them.
-    if(units_changed & HOUR_UNIT && options.hourly_vibe == 1) {
-        vibes_short_pulse();
+// Bring the screen in line with clock_time, the battery and the options.  Only layers whose inputs changed since
+// they were last drawn are updated.
+static void update_display() {
+    int     number;
+    int32_t angle;
+    bool    hidden;
+
+    //Nothing to update before the layers exist.
+    if(hand_layer == NULL) {
+        return;
     }
 
-    // If the user desires the hour hand, do this.
+    //The centered number is the minute, or the hour when the hand shows the minutes.  With hourly ticks the minutes
+    //would go stale, so they are not shown at all.
     if(options.minute_hands == 0) {
-        if(units_changed & HOUR_UNIT) {
-            // Update the layer.
-            layer_mark_dirty(hand_layer);
-        } else {
-            //Update the number here because it wouldn't have been done otherwise.
-            update_number(tick_time->tm_min);
-        }
+        number = powerSaving ? -1 : clock_time.tm_min;
     } else {
-        // If the user wants the minute hand.
-        // Update the layer.
+        number = clock_is_24h_style() ? clock_time.tm_hour : ((clock_time.tm_hour + 11) % 12) + 1;
+    }
+    if(number != shown.number) {
+        shown.number = number;
+        layer_mark_dirty(number_layer);
+    }
+
+    //If the day changed, we update day, month, and day of the week.
+    if(clock_time.tm_mday != shown.mday || clock_time.tm_mon != shown.mon || clock_time.tm_wday != shown.wday) {
+        update_date(&clock_time);
+        shown.mday = clock_time.tm_mday;
+        shown.mon  = clock_time.tm_mon;
+        shown.wday = clock_time.tm_wday;
+    }
+
+    angle  = hand_angle(&clock_time);
+    hidden = blackCharging || (powerSaving && options.minute_hands == 1);
+    if(angle != shown.angle || battery_level != shown.battery_level || options.battery_hand != shown.battery_hand ||
+       options.inverted_colors != shown.inverted_colors || hidden != shown.hidden) {
         layer_mark_dirty(hand_layer);
+        shown.angle           = angle;
+        shown.battery_level   = battery_level;
+        shown.battery_hand    = options.battery_hand;
+        shown.inverted_colors = options.inverted_colors;
+        shown.hidden          = hidden;
     }
 }
 
+// Called once per minute, or once per hour in low battery mode.
+static void handle_tick(struct tm* tick_time, TimeUnits units_changed) {
+    clock_time = *tick_time;
 
-// Called once per second during charging.
-static void handle_second_tick(struct tm* tick_time, TimeUnits units_changed) {
-    // If this is an even second, then the hands are displayed.  Hands are not displayed for odds seconds.
-    if((tick_time->tm_sec % 2) == 0) {
-        blackCharging = false;
-    } else {
-        blackCharging = true;
+    //If the user wants hourly vibes, give it to them.  Not when the battery is low.
+    if(units_changed & HOUR_UNIT && options.hourly_vibe == 1 && !powerSaving) {
+        vibes_short_pulse();
+        STAT_ADD(vibes, 1);
     }
-    // Mark the layer dirty so the hands can be redrawn.
-    layer_mark_dirty(hand_layer);
 
-    // If the day or hour changed, we call the minute handler to update these things.
-    if(units_changed & DAY_UNIT) {
-        handle_minute_tick(tick_time, DAY_UNIT);
-    } else if(units_changed & HOUR_UNIT) {
-        handle_minute_tick(tick_time, HOUR_UNIT);
+    update_display();
+
+#ifdef MINIMAL_STATS
+    if(powerSaving) {
+        STAT_ADD(hour_ticks, 1);
+    } else {
+        STAT_ADD(minute_ticks, 1);
     }
+    stats.minutes = (time(NULL) - stats_launch) / 60;
+    if(stats.minutes >= stats_sent_minutes + STATS_PERIOD_MIN) {
+        stats_sent_minutes = stats.minutes;
+        SendStats();
+    }
+#endif
 }
 
-// Toggle the tick timer subscription.
+// Subscribe to the tick service at the rate the display needs.
 static void ToggleTickTimer() {
-    tick_timer_service_unsubscribe();
-    if(options.charge_blink == 1 && isCharging) {
-        tick_timer_service_subscribe(SECOND_UNIT, &handle_second_tick);
-    } else {
-        tick_timer_service_subscribe(MINUTE_UNIT, &handle_minute_tick);
+    tick_timer_service_subscribe(powerSaving ? HOUR_UNIT : MINUTE_UNIT, &handle_tick);
+}
+
+// Read the clock into clock_time and update the display, outside of the tick handler.
+static void update_clock() {
+    time_t now = time(NULL);
+
+    clock_time = *localtime(&now);
+    update_display();
+}
+
+// Called at each phase change of the charge blink.
+static void blink_timer_callback(void *data) {
+    blackCharging = !blackCharging;
+    blink_timer   = app_timer_register(blackCharging ? CHARGE_BLINK_OFF_MS : CHARGE_BLINK_PERIOD_MS - CHARGE_BLINK_OFF_MS, &blink_timer_callback, NULL);
+
+    // Redraw the hands for the new phase.
+    update_display();
+}
+
+// Start or stop the charge blink.  The hand blinks while charging, if the user wants it, until the battery is full.
+static void ToggleChargeBlink(int charge_percent) {
+    bool blink = options.charge_blink == 1 && isCharging && charge_percent < 100;
+
+    if(blink && blink_timer == NULL) {
+        // Start with the hand hidden so the user sees the charger was noticed.
+        blackCharging = true;
+        blink_timer   = app_timer_register(CHARGE_BLINK_OFF_MS, &blink_timer_callback, NULL);
+        update_display();
+    } else if(!blink && blink_timer != NULL) {
+        app_timer_cancel(blink_timer);
+        blink_timer   = NULL;
+        blackCharging = false;
+        update_display();
+    }
+}
+
+// Low battery mode is on below the user's threshold, until the watch goes on the charger.
+static bool WantPowerSave(BatteryChargeState charge_state) {
+    return options.power_save > 0 && !charge_state.is_charging && !charge_state.is_plugged && charge_state.charge_percent < options.power_save;
+}
+
+// Enter or leave low battery mode.  The face then ticks hourly, hides the minutes and keeps the battery hand at the
+// length it had; leaving it brings the clock and the hand up to date.  There is no charge blink to stop: charging
+// ends the mode.
+static void TogglePowerSave(BatteryChargeState charge_state) {
+    bool saving = WantPowerSave(charge_state);
+
+    if(saving == powerSaving) {
+        return;
     }
+    powerSaving = saving;
+    if(!powerSaving) {
+        UpdateBatteryHands(charge_state.charge_percent);
+    }
+    ToggleTickTimer();
+    update_clock();
+    DRAIN_MODE_CHANGED();
 }
 
 // Handler for a battery status change.
 static void battery_change(BatteryChargeState charge_state) {
-    // Re-create batt hand.
-    gpath_destroy(batt_hand);
-    gpath_destroy(batt_hand2);
-    CreateBatteryHands(charge_state.charge_percent);
+    TogglePowerSave(charge_state);
 
-    // If the watch was charging, but is no longer, change things.
-    if(!charge_state.is_charging && isCharging) {
-        // Change the control variables.
-        isCharging    = false;
-        blackCharging = false;
+    // Resize batt hand, unless it is frozen for low battery mode.
+    if(!powerSaving) {
+        UpdateBatteryHands(charge_state.charge_percent);
+    }
+
+    // Follow the charger, and start or stop blinking to match.  Blinking also stops once the battery is full.
+    isCharging = charge_state.is_charging;
+    ToggleChargeBlink(charge_state.charge_percent);
+
+    // Redraw the hand if its length changed.
+    update_display();
+}
 
-        //Unsubscribe from the second handler because we don't need it and subscribe to the minute handler.
-        ToggleTickTimer();
+// Refresh the date and hand after a reconnect, in case the phone changed the time.
+static void resync_timer_callback(void *data) {
+    time_t now = time(NULL);
+
+    resync_timer = NULL;
+    // Once the clock has run undisturbed since the last refresh, the phone is done with it.
+    if(resync_attempt > 0 && now - resync_expected <= 1 && resync_expected - now <= 1) {
+        return;
     }
-    // If the watching wasn't charging, but now is, we update things.
-    // Note: the flashing should stop when the battery is fully charged, but the watch is still plugged in.
-    if(!isCharging && charge_state.is_charging) {
-        // Change the control variables.
-        isCharging = true;
+    update_clock();
 
-        //If the user wants the charging blink feature, turn it on.
-        if(options.charge_blink == 1) {
-            ToggleTickTimer();
-            blackCharging = true;
-        }
+    resync_attempt++;
+    if(resync_attempt < RESYNC_ATTEMPTS) {
+        resync_expected = now + (RESYNC_FIRST_MS << resync_attempt) / 1000;
+        resync_timer    = app_timer_register(RESYNC_FIRST_MS << resync_attempt, &resync_timer_callback, NULL);
     }
-    // Mark the hand layer dirty to redraw it.
-    layer_mark_dirty(hand_layer);
 }
 
-// If the bluetooth connection status has changed, we vibrate appropriately and change the control variables.
-static void bluetooth_change(bool connected) {
-    if(!connected && wasConnected) {
-        wasConnected = false;
-        vibes_long_pulse();
-    } else if(connected && !wasConnected) {
-        wasConnected = true;
+// Called once the bluetooth connection has stopped changing.  We vibrate appropriately and change the control variables.
+static void bluetooth_settled(void *data) {
+    bool connected = bluetooth_connection_service_peek();
+
+    bluetooth_timer = NULL;
+    if(!connected) {
+        if(wasConnected) {
+            vibes_long_pulse();
+            STAT_ADD(vibes, 1);
+        }
+    } else if(!wasConnected || bluetoothDropped) {
         vibes_double_pulse();
+        STAT_ADD(vibes, 1);
         // Update the time in case it has changed (e.g. flight across time zones).
-        psleep(10000);
-        time_t    now           = time(NULL);
-        struct tm *current_time = localtime(&now);
-        handle_minute_tick(current_time, DAY_UNIT);
+        resync_attempt = 0;
+        if(resync_timer != NULL) {
+            app_timer_cancel(resync_timer);
+        }
+        resync_timer = app_timer_register(RESYNC_FIRST_MS, &resync_timer_callback, NULL);
     }
+    wasConnected     = connected;
+    bluetoothDropped = false;
 }
 
-// This is called when the phone wishes to update the options via AppSync.
-static void sync_tuple_changed_callback(const uint32_t key, const Tuple *new_tuple, const Tuple *old_tuple, void *context) {
-    switch(key) {
-    case BLUETOOTH_VIBE_KEY:
-        options.bluetooth_vibe = new_tuple->value->uint8;
-        bluetooth_connection_service_unsubscribe();
+// If the bluetooth connection status has changed, wait for it to settle before telling the user.
+static void bluetooth_change(bool connected) {
+    if(!connected) {
+        bluetoothDropped = true;
+    }
+    if(bluetooth_timer == NULL || !app_timer_reschedule(bluetooth_timer, BLUETOOTH_SETTLE_MS)) {
+        bluetooth_timer = app_timer_register(BLUETOOTH_SETTLE_MS, &bluetooth_settled, NULL);
+    }
+}
+
+//FNV-1a over a record in flash, to catch a torn or corrupt one.
+static uint32_t record_checksum(const void *record, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)record;
+    uint32_t      hash   = 2166136261u;
+
+    for(size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+//Reads the options record, falling back to the legacy per-key layout and then to the defaults.
+static void load_options(void) {
+    struct PersistRecord record;
+
+    if(persist_read_data(OPTIONS_KEY, &record, sizeof(record)) == (int)sizeof(record) &&
+       record.options.storage_version == OPTIONS_VERSION &&
+       record.checksum == record_checksum(&record.options, sizeof(record.options))) {
+        options      = record.options;
+        optionsDirty = false;
+        return;
+    }
+
+    //The legacy layout always wrote every key, the version last.
+    bool legacy = persist_exists(STORAGE_VERSION_KEY);
+    options.bluetooth_vibe  = legacy && persist_exists(BLUETOOTH_VIBE_KEY) ? persist_read_int(BLUETOOTH_VIBE_KEY) : 1;
+    options.hourly_vibe     = legacy && persist_exists(HOURLY_VIBE_KEY) ? persist_read_int(HOURLY_VIBE_KEY) : 0;
+    options.battery_hand    = legacy && persist_exists(BATTERY_HAND_KEY) ? persist_read_int(BATTERY_HAND_KEY) : 1;
+    options.charge_blink    = legacy && persist_exists(CHARGE_BLINK_KEY) ? persist_read_int(CHARGE_BLINK_KEY) : 1;
+    options.inverted_colors = legacy && persist_exists(INVERTED_COLORS_KEY) ? persist_read_int(INVERTED_COLORS_KEY) : 0;
+    options.minute_hands    = legacy && persist_exists(MINUTE_HANDS_KEY) ? persist_read_int(MINUTE_HANDS_KEY) : 0;
+    options.power_save      = 0;
+    options.storage_version = OPTIONS_VERSION;
+
+    //Write the record on exit so the next launch takes the fast path.
+    optionsDirty = true;
+}
+
+//Writes the options record if anything changed, then drops the legacy keys it replaces.
+static void save_options(void) {
+    struct PersistRecord record;
+
+    if(!optionsDirty) {
+        return;
+    }
+    record.options  = options;
+    record.checksum = record_checksum(&record.options, sizeof(record.options));
+    if(persist_write_data(OPTIONS_KEY, &record, sizeof(record)) != (int)sizeof(record)) {
+        return;
+    }
+    optionsDirty = false;
+
+    if(persist_exists(STORAGE_VERSION_KEY)) {
+        persist_delete(BLUETOOTH_VIBE_KEY);
+        persist_delete(HOURLY_VIBE_KEY);
+        persist_delete(BATTERY_HAND_KEY);
+        persist_delete(CHARGE_BLINK_KEY);
+        persist_delete(INVERTED_COLORS_KEY);
+        persist_delete(MINUTE_HANDS_KEY);
+        persist_delete(STORAGE_VERSION_KEY);
+    }
+}
+
+// The battery service is needed for the hand's length, the charge blink and low battery mode.
+static bool WantBatteryService(const struct Persist *o) {
+    return o->battery_hand == 1 || o->charge_blink == 1 || o->power_save > 0;
+}
+
+// Moves to the options that came in from the phone in one pass.  Each service, hand and color is brought in line
+// with the options that actually changed, once, however many of them a message carries.
+static void ApplyOptions(const struct Persist *received) {
+    struct Persist     previous = options;
+    BatteryChargeState charge   = battery_state_service_peek();
+    bool               saving   = powerSaving;
+
+    options                 = *received;
+    options.storage_version = previous.storage_version;
+    if(memcmp(&options, &previous, sizeof(options)) == 0) {
+        return;
+    }
+    optionsDirty = true;
+
+    if(options.bluetooth_vibe != previous.bluetooth_vibe) {
         wasConnected = bluetooth_connection_service_peek();
         if(options.bluetooth_vibe == 1) {
             bluetooth_connection_service_subscribe(&bluetooth_change);
+        } else {
+            bluetooth_connection_service_unsubscribe();
+            //A change that has not settled yet would still vibrate.
+            if(bluetooth_timer != NULL) {
+                app_timer_cancel(bluetooth_timer);
+                bluetooth_timer = NULL;
+            }
         }
-        break;
-    case HOURLY_VIBE_KEY:
-        options.hourly_vibe = new_tuple->value->uint8;
-        break;
-    case BATTERY_HAND_KEY:
-        options.battery_hand = new_tuple->value->uint8;
-        if(options.battery_hand == 0 && options.charge_blink == 0) {
-            battery_state_service_unsubscribe();
+    }
+
+    //Without the battery service the charge we last saw may be stale, so start from a fresh one.
+    if(WantBatteryService(&options) != WantBatteryService(&previous)) {
+        if(WantBatteryService(&options)) {
+            battery_state_service_subscribe(&battery_change);
         } else {
-            gpath_destroy(batt_hand);
-            gpath_destroy(batt_hand2);
-            CreateBatteryHands(battery_state_service_peek().charge_percent);
-            if(options.charge_blink == 0) {
-                battery_state_service_subscribe(&battery_change);
+            battery_state_service_unsubscribe();
+        }
+    }
+    isCharging = charge.is_charging;
+
+    if(options.inverted_colors != previous.inverted_colors) {
+        GColor text = options.inverted_colors == 0 ? GColorWhite : GColorBlack;
+
+        window_set_background_color(window, options.inverted_colors == 0 ? GColorBlack : GColorWhite);
+        text_layer_set_text_color(month_layer, text);
+        text_layer_set_text_color(weather_layer, text);
+    }
+
+    //Low battery mode first: it decides whether the battery hand follows the charge.
+    TogglePowerSave(charge);
+    if(!powerSaving) {
+        UpdateBatteryHands(charge.charge_percent);
+    }
+    ToggleChargeBlink(charge.charge_percent);
+    update_display();
+
+    //Entering or leaving low battery mode already told the worker.
+    if(powerSaving == saving) {
+        DRAIN_MODE_CHANGED();
+    }
+}
+
+//The options packed as CONFIG_KEY carries them.
+static uint32_t PackConfig() {
+    return (uint32_t)CONFIG_VERSION << CONFIG_VERSION_SHIFT | (uint32_t)(options.power_save & 0xff) << CONFIG_POWER_SAVE_SHIFT |
+           (options.bluetooth_vibe & 1) << BLUETOOTH_VIBE_KEY | (options.hourly_vibe & 1) << HOURLY_VIBE_KEY |
+           (options.battery_hand & 1) << BATTERY_HAND_KEY | (options.charge_blink & 1) << CHARGE_BLINK_KEY |
+           (options.inverted_colors & 1) << INVERTED_COLORS_KEY | (options.minute_hands & 1) << MINUTE_HANDS_KEY;
+}
+
+//Tells the phone which options the watch has, when it asks.  The phone then sends its options
+//only if they differ.
+static void SendConfigRevision() {
+    DictionaryIterator *iter;
+
+    if(app_message_outbox_begin(&iter) != APP_MSG_OK) {
+        CONFIG_REPLY_PENDING(true);
+        return;
+    }
+    CONFIG_REPLY_PENDING(false);
+    dict_write_uint32(iter, STORAGE_VERSION_KEY, PackConfig());
+    app_message_outbox_send();
+}
+
+//Reads an option sent the legacy way, as its own int.  Options missing from the message keep their value.
+static int legacy_option(DictionaryIterator *iter, const uint32_t key, int value) {
+    Tuple *tuple = dict_find(iter, key);
+
+    return tuple != NULL ? tuple->value->uint8 : value;
+}
+
+// This is called when the phone sends the options, or asks which options the watch has.
+static void inbox_received(DictionaryIterator *iter, void *context) {
+    struct Persist received = options;
+    Tuple          *config  = dict_find(iter, CONFIG_KEY);
+
+    STAT_ADD(messages, 1);
+
+    //STORAGE_VERSION_KEY from the phone, whatever its value, is the question.  Its script sends it once it is running.
+    if(dict_find(iter, STORAGE_VERSION_KEY) != NULL) {
+        SendConfigRevision();
+        return;
+    }
+
+    if(config != NULL) {
+        uint32_t bits = config->value->uint32;
+
+        //A format this watch does not understand is ignored rather than misread.
+        if(bits >> CONFIG_VERSION_SHIFT != CONFIG_VERSION) {
+            return;
+        }
+        received.bluetooth_vibe  = (bits >> BLUETOOTH_VIBE_KEY) & 1;
+        received.hourly_vibe     = (bits >> HOURLY_VIBE_KEY) & 1;
+        received.battery_hand    = (bits >> BATTERY_HAND_KEY) & 1;
+        received.charge_blink    = (bits >> CHARGE_BLINK_KEY) & 1;
+        received.inverted_colors = (bits >> INVERTED_COLORS_KEY) & 1;
+        received.minute_hands    = (bits >> MINUTE_HANDS_KEY) & 1;
+        received.power_save      = (bits >> CONFIG_POWER_SAVE_SHIFT) & 0xff;
+    } else {
+        received.bluetooth_vibe  = legacy_option(iter, BLUETOOTH_VIBE_KEY, received.bluetooth_vibe);
+        received.hourly_vibe     = legacy_option(iter, HOURLY_VIBE_KEY, received.hourly_vibe);
+        received.battery_hand    = legacy_option(iter, BATTERY_HAND_KEY, received.battery_hand);
+        received.charge_blink    = legacy_option(iter, CHARGE_BLINK_KEY, received.charge_blink);
+        received.inverted_colors = legacy_option(iter, INVERTED_COLORS_KEY, received.inverted_colors);
+        received.minute_hands    = legacy_option(iter, MINUTE_HANDS_KEY, received.minute_hands);
+        received.power_save      = legacy_option(iter, POWER_SAVE_KEY, received.power_save);
+    }
+
+    ApplyOptions(&received);
+}
+
+// The last frame is kept in flash so the next launch can put it up at once and build the face behind it.  It is
+// only shown if it is still what the face would draw: same minute, options, battery hand, charger and low battery
+// mode.  1-bit frames only; a color frame would not fit in FRAME_CHUNKS keys.
+#define FRAME_CHUNKS    8
+#define FRAME_SIZE_MAX  (FRAME_CHUNKS * PERSIST_DATA_MAX_LENGTH)
+#define FRAME_ROW_BYTES (SCREEN_WIDTH / 8)
+
+typedef struct {
+    uint32_t minute;        // time() / 60 when it was drawn.
+    uint32_t config;        // The options, as PackConfig() has them.
+    uint8_t  battery_level;
+    uint8_t  charging;
+    uint8_t  power_saving;
+    uint8_t  clock_24h;
+} FrameStamp;
+
+// The frame's record under FRAME_KEY.
+struct FrameRecord {
+    FrameStamp stamp;
+    uint32_t   size;        // Bytes of run-length coded pixels.
+    uint32_t   checksum;    // Of the pixels, worked out when they are saved.
+};
+
+static struct FrameRecord frame_record;
+static uint8_t            *frame_pixels;   // The run-length coded frame of frame_record, if its size is not 0.
+static uint32_t           frame_capacity; // Bytes allocated at frame_pixels.  Only grows.
+static bool               frame_saved;    // frame_pixels is what is in flash.
+static AppTimer           *build_timer;  // Set while the launch shows the saved frame and the face is not built yet.
+
+static FrameStamp MakeFrameStamp(int level, bool charging, bool saving) {
+    FrameStamp stamp;
+
+    memset(&stamp, 0, sizeof(stamp));
+    stamp.minute        = time(NULL) / 60;
+    stamp.config        = PackConfig();
+    stamp.battery_level = level;
+    stamp.charging      = charging;
+    stamp.power_saving  = saving;
+    stamp.clock_24h     = clock_is_24h_style();
+    return stamp;
+}
+
+#ifdef PBL_BW
+// Byte i of the frame's pixels, row after row, without the padding at the end of each row.
+static uint8_t *frame_byte(GBitmap *frame_buffer, int i) {
+    return gbitmap_get_data(frame_buffer) + i / FRAME_ROW_BYTES * gbitmap_get_bytes_per_row(frame_buffer) + i % FRAME_ROW_BYTES;
+}
+
+// Run-length codes the frame into out, or only sizes it if out is NULL.  A control byte c < 128 is followed by c + 1
+// literal bytes; c >= 128 by one byte that repeats c - 126 times.  Returns 0 if it takes more than capacity bytes.
+static uint32_t PackFrame(GBitmap *frame_buffer, uint8_t *out, uint32_t capacity) {
+    const int n    = SCREEN_HEIGHT * FRAME_ROW_BYTES;
+    uint32_t  size = 0;
+    int       i    = 0;
+
+    while(i < n) {
+        uint8_t byte = *frame_byte(frame_buffer, i);
+        int     run  = 1;
+
+        while(i + run < n && run < 129 && *frame_byte(frame_buffer, i + run) == byte) {
+            run++;
+        }
+        if(run >= 2) {
+            if(size + 2 > capacity) {
+                return 0;
+            }
+            if(out != NULL) {
+                out[size]     = 126 + run;
+                out[size + 1] = byte;
             }
+            size += 2;
+            i    += run;
+            continue;
         }
-        layer_mark_dirty(hand_layer);
-        break;
-    case CHARGE_BLINK_KEY:
-        options.charge_blink = new_tuple->value->uint8;
-        isCharging           = battery_state_service_peek().is_charging;
-        ToggleTickTimer();
-        if(options.charge_blink == 0) {
-            if(options.battery_hand == 0) {
-                battery_state_service_subscribe(&battery_change);
+
+        //Literal bytes, up to where the next run starts.
+        while(i + run < n && run < 128 &&
+              (i + run + 1 == n || *frame_byte(frame_buffer, i + run) != *frame_byte(frame_buffer, i + run + 1))) {
+            run++;
+        }
+        if(size + 1 + run > capacity) {
+            return 0;
+        }
+        if(out != NULL) {
+            out[size] = run - 1;
+            for(int j = 0; j < run; j++) {
+                out[size + 1 + j] = *frame_byte(frame_buffer, i + j);
             }
         }
-        break;
-    case INVERTED_COLORS_KEY:
-        options.inverted_colors = new_tuple->value->uint8;
-        if(options.inverted_colors == 0) {
-            window_set_background_color(window, GColorBlack);
-            text_layer_set_text_color(time_layer, GColorWhite);
-            text_layer_set_text_color(month_layer, GColorWhite);
-            text_layer_set_text_color(weather_layer, GColorWhite);
-            layer_mark_dirty(hand_layer);
+        size += 1 + run;
+        i    += run;
+    }
+    return size;
+}
+
+// Undoes PackFrame.  Stops at the end of the frame whatever the data says.
+static void UnpackFrame(GBitmap *frame_buffer, const uint8_t *in, uint32_t size) {
+    const int n = SCREEN_HEIGHT * FRAME_ROW_BYTES;
+    uint32_t  p = 0;
+    int       i = 0;
+
+    while(p < size && i < n) {
+        uint8_t control = in[p++];
+
+        if(control >= 128) {
+            for(int j = 0; j < control - 126 && i < n && p < size; j++) {
+                *frame_byte(frame_buffer, i++) = in[p];
+            }
+            p++;
         } else {
-            window_set_background_color(window, GColorWhite);
-            text_layer_set_text_color(time_layer, GColorBlack);
-            text_layer_set_text_color(month_layer, GColorBlack);
-            text_layer_set_text_color(weather_layer, GColorBlack);
-            layer_mark_dirty(hand_layer);
+            for(int j = 0; j <= control && i < n && p < size; j++) {
+                *frame_byte(frame_buffer, i++) = in[p++];
+            }
         }
-        break;
-    case MINUTE_HANDS_KEY:
-        options.minute_hands = new_tuple->value->uint8;
-        layer_mark_dirty(hand_layer);
-        break;
     }
 }
 
-// Handle the start-up of the app
-static void do_init(void) {
-    //Initialize the options struct by looking for persistent data.
-    options.bluetooth_vibe  = persist_exists(BLUETOOTH_VIBE_KEY) ? persist_read_int(BLUETOOTH_VIBE_KEY) : 1;
-    options.hourly_vibe     = persist_exists(HOURLY_VIBE_KEY) ? persist_read_int(HOURLY_VIBE_KEY) : 0;
-    options.battery_hand    = persist_exists(BATTERY_HAND_KEY) ? persist_read_int(BATTERY_HAND_KEY) : 1;
-    options.charge_blink    = persist_exists(CHARGE_BLINK_KEY) ? persist_read_int(CHARGE_BLINK_KEY) : 1;
-    options.inverted_colors = persist_exists(INVERTED_COLORS_KEY) ? persist_read_int(INVERTED_COLORS_KEY) : 0;
-    options.minute_hands    = persist_exists(MINUTE_HANDS_KEY) ? persist_read_int(MINUTE_HANDS_KEY) : 0;
-    options.storage_version = persist_exists(STORAGE_VERSION_KEY) ? persist_read_int(STORAGE_VERSION_KEY) : 2;
+// The topmost layer.  Puts up the saved frame until the face is built, then keeps a copy of every frame that shows
+// something new.
+static void frame_update(Layer *layer, GContext *ctx) {
+    GBitmap    *frame_buffer = graphics_capture_frame_buffer(ctx);
+    FrameStamp stamp;
+    uint32_t   size;
 
-    // Create our app's base window
-    window = window_create();
-    window_set_background_color(window, options.inverted_colors == 1 ? GColorWhite : GColorBlack);
-    window_stack_push(window, true);
+    if(frame_buffer == NULL) {
+        return;
+    }
+    if(build_timer != NULL) {
+        UnpackFrame(frame_buffer, frame_pixels, frame_record.size);
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return;
+    }
 
-    Layer *root_layer = window_get_root_layer(window);
-    GRect bounds      = layer_get_bounds(root_layer);
-    center = grect_center_point(&bounds);
+    stamp = MakeFrameStamp(battery_level, isCharging, powerSaving);
+    if(memcmp(&stamp, &frame_record.stamp, sizeof(stamp)) != 0) {
+        //The frame is packed into the buffer the last one left.  Only a frame that takes more sizes it first and
+        //moves to a bigger buffer.
+        size = frame_pixels != NULL ? PackFrame(frame_buffer, frame_pixels, frame_capacity) : 0;
+        if(size == 0) {
+            size = PackFrame(frame_buffer, NULL, FRAME_SIZE_MAX);
+            free(frame_pixels);
+            frame_pixels   = size > 0 ? malloc(size) : NULL;
+            frame_capacity = frame_pixels != NULL ? size : 0;
+            size           = frame_pixels != NULL ? PackFrame(frame_buffer, frame_pixels, frame_capacity) : 0;
+        }
+        frame_record.stamp = stamp;
+        frame_record.size  = size;
+        frame_saved        = false;
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+}
 
-    // Declare input and output buffer sizes for AppSync.
-    const int inbound_size  = 96;
-    const int outbound_size = 96;
-    app_message_open(inbound_size, outbound_size);
+// Reads the saved frame if it is what this launch would draw.
+static bool LoadFrame() {
+    BatteryChargeState charge = battery_state_service_peek();
+    FrameStamp         stamp  = MakeFrameStamp(BatteryLevel(charge.charge_percent), charge.is_charging, WantPowerSave(charge));
+    struct FrameRecord record;
+    uint8_t            *pixels;
+    uint32_t           read   = 0;
 
-    // Tuplet of initial values for the options.
-    Tuplet initial_values[] = {
-        TupletInteger(BLUETOOTH_VIBE_KEY,  options.bluetooth_vibe),
-        TupletInteger(HOURLY_VIBE_KEY,     options.hourly_vibe),
-        TupletInteger(BATTERY_HAND_KEY,    options.battery_hand),
-        TupletInteger(CHARGE_BLINK_KEY,    options.charge_blink),
-        TupletInteger(INVERTED_COLORS_KEY, options.inverted_colors),
-        TupletInteger(MINUTE_HANDS_KEY,    options.minute_hands)
-    };
+    if(persist_read_data(FRAME_KEY, &record, sizeof(record)) != (int)sizeof(record) ||
+       memcmp(&stamp, &record.stamp, sizeof(stamp)) != 0 || record.size == 0 || record.size > FRAME_SIZE_MAX) {
+        return false;
+    }
+    pixels = malloc(record.size);
+    if(pixels == NULL) {
+        return false;
+    }
+    for(int chunk = 0; read < record.size; chunk++) {
+        uint32_t want = record.size - read < PERSIST_DATA_MAX_LENGTH ? record.size - read : PERSIST_DATA_MAX_LENGTH;
 
-    // Initialize the AppSync.
-    app_sync_init(&sync, sync_buffer, sizeof(sync_buffer), initial_values, ARRAY_LENGTH(initial_values), sync_tuple_changed_callback, NULL, NULL);
+        if(persist_read_data(FRAME_CHUNK_KEY + chunk, pixels + read, want) != (int)want) {
+            break;
+        }
+        read += want;
+    }
+    if(read < record.size || record_checksum(pixels, record.size) != record.checksum) {
+        free(pixels);
+        return false;
+    }
+    frame_record   = record;
+    frame_pixels   = pixels;
+    frame_capacity = record.size;
+    frame_saved    = true;
+    return true;
+}
+
+// Writes the last frame kept, unless flash already has it.  The pixels go first, so a record never describes
+// pixels that are not there.
+static void SaveFrame() {
+    uint32_t written = 0;
+
+    if(frame_record.size == 0 || frame_saved) {
+        return;
+    }
+    frame_record.checksum = record_checksum(frame_pixels, frame_record.size);
+    for(int chunk = 0; written < frame_record.size; chunk++) {
+        uint32_t size = frame_record.size - written < PERSIST_DATA_MAX_LENGTH ? frame_record.size - written : PERSIST_DATA_MAX_LENGTH;
+
+        if(persist_write_data(FRAME_CHUNK_KEY + chunk, frame_pixels + written, size) != (int)size) {
+            return;
+        }
+        written += size;
+    }
+    persist_write_data(FRAME_KEY, &frame_record, sizeof(frame_record));
+}
+#else
+static void frame_update(Layer *layer, GContext *ctx) {
+}
+
+static bool LoadFrame() {
+    return false;
+}
+
+static void SaveFrame() {
+}
+#endif
+
+// Builds the face: messages, fonts, layers, hands and services.
+static void BuildFace() {
+    Layer *root_layer = window_get_root_layer(window);
+
+    // Declare input and output buffer sizes for AppMessage.  The inbox has to fit a legacy client's message, one
+    // int32 per option; the packed one is a single uint32.  The watch sends nothing bigger than that either, bar
+    // the statistics.
+    const uint32_t inbound_size  = dict_calc_buffer_size(OPTION_COUNT, sizeof(int32_t), sizeof(int32_t), sizeof(int32_t),
+                                                         sizeof(int32_t), sizeof(int32_t), sizeof(int32_t), sizeof(int32_t));
+#ifdef MINIMAL_STATS
+    const uint32_t outbound_size = dict_calc_buffer_size(1, sizeof(stats) > sizeof(uint32_t) + DRAIN_LOG_BATCH * sizeof(DrainSample) ?
+                                                         sizeof(stats) : sizeof(uint32_t) + DRAIN_LOG_BATCH * sizeof(DrainSample));
+#else
+    const uint32_t outbound_size = dict_calc_buffer_size(1, sizeof(uint32_t));
+#endif
+    app_message_register_inbox_received(&inbox_received);
+#ifdef MINIMAL_STATS
+    //The drain log goes out behind the first message the phone acknowledges.
+    app_message_register_outbox_sent(&outbox_sent);
+    app_message_register_outbox_failed(&outbox_failed);
+    drain_exported       = persist_exists(DRAIN_LOG_EXPORTED_KEY) ? persist_read_int(DRAIN_LOG_EXPORTED_KEY) : 0;
+    drain_exported_saved = drain_exported;
+#endif
+    app_message_open(inbound_size, outbound_size);
 
-    // Init the text layer used to show the minutes
-    time_layer = text_layer_create(GRect((bounds.size.w - 50) / 2, (bounds.size.h - 50) / 2, 50 /* width */, 50 /* height */));
-    text_layer_set_text_alignment(time_layer, GTextAlignmentCenter);
-    text_layer_set_text_color(time_layer, options.inverted_colors == 0 ? GColorWhite : GColorBlack);
-    text_layer_set_background_color(time_layer, GColorClear);
-    text_layer_set_font(time_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_MAIN_40)));
 
     //Init month layer to show month text.
-    month_layer = text_layer_create(GRect(2, bounds.size.h - 18, 60, 18));
-    text_layer_set_text_alignment(month_layer, GTextAlignmentLeft);
+    month_layer = text_layer_create(MONTH_FRAME);
+    text_layer_set_text_alignment(month_layer, MONTH_ALIGNMENT);
     text_layer_set_text_color(month_layer, options.inverted_colors == 0 ? GColorWhite : GColorBlack);
     text_layer_set_background_color(month_layer, GColorClear);
-    text_layer_set_font(month_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_LOWER_15)));
+    text_layer_set_font(month_layer, GetFont(RESOURCE_ID_FONT_LOWER_15));
 
     // Init "weather" layer that show the day of the week.
-    weather_layer = text_layer_create(GRect(bounds.size.w - 36, bounds.size.h - 18, 34, 18));
-    text_layer_set_text_alignment(weather_layer, GTextAlignmentRight);
+    weather_layer = text_layer_create(WEEKDAY_FRAME);
+    text_layer_set_text_alignment(weather_layer, WEEKDAY_ALIGNMENT);
     text_layer_set_text_color(weather_layer, options.inverted_colors == 0 ? GColorWhite : GColorBlack);
     text_layer_set_background_color(weather_layer, GColorClear);
-    text_layer_set_font(weather_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_LOWER_15)));
+    text_layer_set_font(weather_layer, GetFont(RESOURCE_ID_FONT_LOWER_15));
 
     //Init the hand layer used to update the hands.
-    hand_layer = layer_create(bounds);
+    hand_layer = layer_create(SCREEN_FRAME);
     layer_set_update_proc(hand_layer, hand_update);
     layer_add_child(root_layer, hand_layer);
 
+    // Init the layer used to show the minutes, above the hand.
+    number_layer = layer_create(TIME_FRAME);
+    layer_set_update_proc(number_layer, number_update);
+    layer_add_child(root_layer, number_layer);
+
     //Get the current battery state.
-    isCharging    = battery_state_service_peek().is_charging;
-    blackCharging = isCharging;
+    isCharging  = battery_state_service_peek().is_charging;
+    powerSaving = WantPowerSave(battery_state_service_peek());
 
     //Init the hands.
     CreateHourHand();
-    CreateBatteryHands(battery_state_service_peek().charge_percent);
+    CreateBatteryHands();
+    UpdateBatteryHands(battery_state_service_peek().charge_percent);
 
-    // Ensures time is displayed immediately (will break if NULL tick event accessed).
-    // (This is why it's a good idea to have a separate routine to do the update itself.)
-    time_t    now           = time(NULL);
-    struct tm *current_time = localtime(&now);
-    handle_minute_tick(current_time, DAY_UNIT);
+    // Ensures time is displayed immediately.
+    update_clock();
 
-    //Subscribe to the tick service.  If the watch is charging we subscribe the second unit, and minute unit, otherwise.
+    //Subscribe to the tick service.  Blinking while charging runs on its own timer.
     ToggleTickTimer();
+    ToggleChargeBlink(battery_state_service_peek().charge_percent);
 
     //Add the layers to the window.
-    layer_add_child(root_layer, text_layer_get_layer(time_layer));
     layer_add_child(root_layer, text_layer_get_layer(month_layer));
     layer_add_child(root_layer, text_layer_get_layer(weather_layer));
 
-    //Mark the hand layer dirty so the hands will be drawn correctly.
-    layer_mark_dirty(hand_layer);
-
     //Get the current bluetooth state.
     wasConnected = bluetooth_connection_service_peek();
 
@@ -439,34 +1462,101 @@ static void do_init(void) {
     }
 
     //Subscribe to the battery state service.
-    if(options.battery_hand == 1 || options.charge_blink == 1) {
+    if(WantBatteryService(&options)) {
         battery_state_service_subscribe(&battery_change);
     }
+
+#ifdef MINIMAL_STATS
+    //Start the battery logger if it isn't running yet.
+    if(!app_worker_is_running()) {
+        app_worker_launch();
+    }
+    SendDrainMode(true);
+#endif
+
+    //The frame layer goes back on top, over the layers just added.
+    layer_remove_from_parent(frame_layer);
+    layer_add_child(root_layer, frame_layer);
 }
 
-static void do_deinit(void) {
-    //Write to persistent data.
-    persist_write_int(BLUETOOTH_VIBE_KEY, options.bluetooth_vibe);
-    persist_write_int(HOURLY_VIBE_KEY, options.hourly_vibe);
-    persist_write_int(BATTERY_HAND_KEY, options.battery_hand);
-    persist_write_int(CHARGE_BLINK_KEY, options.charge_blink);
-    persist_write_int(INVERTED_COLORS_KEY, options.inverted_colors);
-    persist_write_int(MINUTE_HANDS_KEY, options.minute_hands);
-    persist_write_int(STORAGE_VERSION_KEY, options.storage_version);
-
-    //Destroy everything.
-    layer_remove_child_layers(window_get_root_layer(window));
-    text_layer_destroy(time_layer);
+static void build_timer_callback(void *data) {
+    build_timer = NULL;
+    BuildFace();
+}
+
+// Handle the start-up of the app
+static void do_init(void) {
+    //Initialize the options struct by looking for persistent data.
+    load_options();
+#ifdef MINIMAL_STATS
+    stats_launch = time(NULL);
+#endif
+
+    // Create our app's base window
+    window = window_create();
+    window_set_background_color(window, options.inverted_colors == 1 ? GColorWhite : GColorBlack);
+    window_stack_push(window, true);
+
+    frame_layer = layer_create(SCREEN_FRAME);
+    layer_set_update_proc(frame_layer, frame_update);
+    layer_add_child(window_get_root_layer(window), frame_layer);
+
+    //If the last frame is still current it goes up first, and the face is built once it is on screen.
+    if(LoadFrame()) {
+        build_timer = app_timer_register(0, &build_timer_callback, NULL);
+        layer_mark_dirty(frame_layer);
+    } else {
+        BuildFace();
+    }
+}
+
+// Undoes BuildFace.
+static void TearDownFace() {
+#ifdef MINIMAL_STATS
+    if(drain_exported != drain_exported_saved) {
+        persist_write_int(DRAIN_LOG_EXPORTED_KEY, drain_exported);
+    }
+    SendDrainMode(false);
+#endif
+
+    layer_destroy(number_layer);
+    FreeDigits();
     text_layer_destroy(month_layer);
     text_layer_destroy(weather_layer);
+    UnloadFonts();
     gpath_destroy(hour_hand);
     gpath_destroy(batt_hand);
     gpath_destroy(batt_hand2);
     layer_destroy(hand_layer);
     tick_timer_service_unsubscribe();
+    if(blink_timer != NULL) {
+        app_timer_cancel(blink_timer);
+    }
+    if(bluetooth_timer != NULL) {
+        app_timer_cancel(bluetooth_timer);
+    }
+    if(resync_timer != NULL) {
+        app_timer_cancel(resync_timer);
+    }
     bluetooth_connection_service_unsubscribe();
     battery_state_service_unsubscribe();
-    app_sync_deinit(&sync);
+    app_message_deregister_callbacks();
+}
+
+static void do_deinit(void) {
+    //Write to persistent data, if anything changed.
+    save_options();
+    SaveFrame();
+
+    //Destroy everything.  Closed before the face was built, there is only the window with the saved frame.
+    layer_remove_child_layers(window_get_root_layer(window));
+    if(build_timer != NULL) {
+        app_timer_cancel(build_timer);
+    } else {
+        TearDownFace();
+    }
+    layer_destroy(frame_layer);
+    free(frame_pixels);
     window_destroy(window);
 }
 
@@ -0,0 +1,40 @@
+// Battery drain log of stats builds (waf build --stats), shared by the face and its background worker.
+//
+// The worker samples the battery into a ring of DRAIN_LOG_CHUNKS persistent storage chunks, one sample whenever the
+// charge or the face mode changes.  The face sends the samples the phone has not had yet, DRAIN_LOG_BATCH at a time.
+// Each side owns its keys: the worker writes the state and the chunks, the face only how far it has exported.
+#pragma once
+
+#include <stdint.h>
+
+#define DRAIN_LOG_STATE_KEY     0x20
+#define DRAIN_LOG_EXPORTED_KEY  0x21
+#define DRAIN_LOG_CHUNK_KEY     0x22 // The first of DRAIN_LOG_CHUNKS keys.
+
+#define DRAIN_LOG_CHUNK_SAMPLES 42   // 252 bytes, just under the 256 a key can hold.
+#define DRAIN_LOG_CHUNKS        4
+#define DRAIN_LOG_SAMPLES       (DRAIN_LOG_CHUNK_SAMPLES * DRAIN_LOG_CHUNKS)
+#define DRAIN_LOG_BATCH         16
+
+// AppWorkerMessage type from the face to the worker, with the face mode in data0.
+#define DRAIN_MODE_MESSAGE      0
+
+// Face mode bits.  The low six are the on/off options, numbered as in the face's CONFIG_KEY.
+#define DRAIN_MODE_OPTIONS      0x3f
+#define DRAIN_MODE_POWER_SAVE   0x40 // Low battery mode.
+#define DRAIN_MODE_FOREGROUND   0x80 // The face is on screen.
+
+#define DRAIN_CHARGING          0x80 // Set in DrainSample.charge while charging.
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t time;   // Seconds since the epoch.
+    uint8_t  charge; // Percent, and DRAIN_CHARGING.
+    uint8_t  mode;
+} DrainSample;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t    count; // Samples ever logged.  Sample n is number n % DRAIN_LOG_CHUNK_SAMPLES of chunk
+                       // n / DRAIN_LOG_CHUNK_SAMPLES % DRAIN_LOG_CHUNKS.
+    DrainSample last;
+    uint8_t     mode;  // As last reported by the face.
+} DrainLogState;
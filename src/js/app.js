@@ -1,9 +1,33 @@
 var mConfig = {};
 
+// The watch reports the options it has, packed like "config", when we ask for them (by sending it "storage_version"),
+// which we do each time we start, reconnects included.  Ours are only sent when they differ.  A watch we can't ask gets them straight away.
+var watchConfig = null;
+
 Pebble.addEventListener("ready", function(e) {
     loadLocalData();
     //console.log("Local data loaded: " + JSON.stringify(mConfig));
-    returnConfigToPebble();
+    Pebble.sendAppMessage({
+	    "storage_version":0
+    }, function(e) {
+    }, function(e) {
+	returnConfigToPebble();
+    });
+});
+
+Pebble.addEventListener("appmessage", function(e) {
+    if(e.payload.storage_version !== undefined) {
+	watchConfig = e.payload.storage_version >>> 0;
+	if(watchConfig !== packConfig()) {
+	    returnConfigToPebble();
+	}
+    }
+    if(e.payload.stats) {
+	console.log("Watch stats: " + JSON.stringify(unpackStats(e.payload.stats)));
+    }
+    if(e.payload.drain_log) {
+	console.log("Watch battery log: " + JSON.stringify(unpackDrainLog(e.payload.drain_log)));
+    }
 });
 
 Pebble.addEventListener("showConfiguration", function(e) {
@@ -16,7 +40,9 @@ Pebble.addEventListener("webviewclosed",
 			    //console.log("Web view responded with: " + JSON.stringify(config));
 			    saveLocalData(config);
 			    //console.log("Local data saved as: " + JSON.stringify(mConfig));
-			    returnConfigToPebble();
+			    if(watchConfig !== packConfig()) {
+				returnConfigToPebble();
+			    }
 			}
 		       );
 
@@ -28,6 +54,10 @@ function saveLocalData(config) {
     localStorage.setItem("charge_blink", parseInt(config.charge_blink));
     localStorage.setItem("inverted_colors", parseInt(config.inverted_colors));
     localStorage.setItem("minute_hands", parseInt(config.minute_hands));
+    // Low battery threshold in percent, 0 for off.  Pages that don't offer it leave it as it was.
+    if(config.power_save !== undefined) {
+	localStorage.setItem("power_save", parseInt(config.power_save));
+    }
 
     loadLocalData();
 
@@ -40,6 +70,7 @@ function loadLocalData() {
     mConfig.charge_blink = parseInt(localStorage.getItem("charge_blink"));
     mConfig.inverted_colors = parseInt(localStorage.getItem("inverted_colors"));
     mConfig.minute_hands = parseInt(localStorage.getItem("minute_hands"));
+    mConfig.power_save = parseInt(localStorage.getItem("power_save"));
     mConfig.configureUrl = "http://thedadams.com/watchface/index.html";
 
     if(isNaN(mConfig.bluetooth_vibe)) {
@@ -60,15 +91,66 @@ function loadLocalData() {
     if(isNaN(mConfig.minute_hands)) {
 	    mConfig.minute_hands = 0;
     }
+    // Off until the configuration page has a low battery setting.
+    if(isNaN(mConfig.power_save)) {
+	    mConfig.power_save = 0;
+    }
+}
+// The options go to the watch packed into one "config" value: one bit per on/off option, numbered like its own
+// appKey, the low battery threshold in the second byte and the format version in the top byte.
+var CONFIG_VERSION = 1;
+var CONFIG_OPTIONS = ["bluetooth_vibe", "hourly_vibe", "battery_hand", "charge_blink", "inverted_colors", "minute_hands"];
+
+function packConfig() {
+    var bits = CONFIG_VERSION << 24;
+    for(var i = 0; i < CONFIG_OPTIONS.length; i++) {
+	if(parseInt(mConfig[CONFIG_OPTIONS[i]]) == 1) {
+	    bits |= 1 << i;
+	}
+    }
+    bits |= (Math.min(Math.max(parseInt(mConfig.power_save), 0), 100) & 0xff) << 8;
+    return bits >>> 0;
 }
 function returnConfigToPebble() {
+    var config = packConfig();
     Pebble.sendAppMessage({
-	    "bluetooth_vibe":parseInt(mConfig.bluetooth_vibe),
-	    "hourly_vibe":parseInt(mConfig.hourly_vibe),
-	    "battery_hand":parseInt(mConfig.battery_hand),
-	    "charge_blink":parseInt(mConfig.charge_blink),
-        "inverted_colors":parseInt(mConfig.inverted_colors),
-        "minute_hands":parseInt(mConfig.minute_hands)
+	    "config":config
+    }, function(e) {
+	watchConfig = config;
     });
     //console.log("Message sent");
-}
\ No newline at end of file
+}
+
+// Field statistics from watches built with "waf build --stats": little-endian uint32s in the order of the stats
+// struct in Minimal.c, counted since the face was launched.
+var STATS_FIELDS = ["minutes", "hand_updates", "draw_ms", "draw_ms_max", "minute_ticks", "hour_ticks", "gpath_builds",
+		    "vibes", "messages"];
+
+function unpackStats(bytes) {
+    var stats = {};
+    for(var i = 0; i < STATS_FIELDS.length && 4 * i + 3 < bytes.length; i++) {
+	stats[STATS_FIELDS[i]] = (bytes[4 * i] | bytes[4 * i + 1] << 8 | bytes[4 * i + 2] << 16 | bytes[4 * i + 3] << 24) >>> 0;
+    }
+    return stats;
+}
+
+// Battery log batches from the same builds' background worker: the little-endian uint32 number of the first sample,
+// then six bytes per sample (uint32 seconds since the epoch, charge percent with 0x80 set while charging, face mode).
+// The low six bits of the mode are the options, numbered like CONFIG_OPTIONS; 0x40 is low battery mode and 0x80 is
+// set while the face is on screen.
+function readUint32(bytes, i) {
+    return (bytes[i] | bytes[i + 1] << 8 | bytes[i + 2] << 16 | bytes[i + 3] << 24) >>> 0;
+}
+
+function unpackDrainLog(bytes) {
+    var log = { first: readUint32(bytes, 0), samples: [] };
+    for(var i = 4; i + 5 < bytes.length; i += 6) {
+	log.samples.push({
+	    time: readUint32(bytes, i),
+	    percent: bytes[i + 4] & 0x7f,
+	    charging: (bytes[i + 4] & 0x80) != 0,
+	    mode: bytes[i + 5]
+	});
+    }
+    return log;
+}
@@ -0,0 +1,69 @@
+#include <pebble_worker.h>
+
+#include "../src/drain_log.h"
+
+// Background worker of stats builds: logs the battery into flash for the face to pass on to the phone, so the drain
+// can be told apart by face configuration.  It only wakes for battery changes and for the face's mode messages.
+static DrainLogState      state;
+static DrainSample        chunk[DRAIN_LOG_CHUNK_SAMPLES]; // The chunk being filled.
+static BatteryChargeState charge;
+
+// Appends a sample for the current charge and mode, unless neither changed since the last one.
+static void log_sample() {
+    uint32_t    index  = state.count % DRAIN_LOG_CHUNK_SAMPLES;
+    DrainSample sample = { (uint32_t)time(NULL), charge.charge_percent | (charge.is_charging ? DRAIN_CHARGING : 0), state.mode };
+
+    if(state.count > 0 && sample.charge == state.last.charge && sample.mode == state.last.mode) {
+        return;
+    }
+    if(index == 0) {
+        memset(chunk, 0, sizeof(chunk));
+    }
+    chunk[index] = sample;
+    state.last   = sample;
+    state.count++;
+
+    // The chunk first, so the state never counts a sample that is not in flash.
+    persist_write_data(DRAIN_LOG_CHUNK_KEY + (state.count - 1) / DRAIN_LOG_CHUNK_SAMPLES % DRAIN_LOG_CHUNKS, chunk,
+                       (index + 1) * sizeof(DrainSample));
+    persist_write_data(DRAIN_LOG_STATE_KEY, &state, sizeof(state));
+}
+
+static void battery_change(BatteryChargeState charge_state) {
+    charge = charge_state;
+    log_sample();
+}
+
+// The face tells us its mode when it starts, when an option changes and when it closes.
+static void message_received(uint16_t type, AppWorkerMessage *data) {
+    if(type == DRAIN_MODE_MESSAGE) {
+        state.mode = data->data0;
+        log_sample();
+    }
+}
+
+static void do_init(void) {
+    if(persist_read_data(DRAIN_LOG_STATE_KEY, &state, sizeof(state)) != (int)sizeof(state)) {
+        memset(&state, 0, sizeof(state));
+    }
+    // Carry on filling the chunk we were on.
+    if(state.count % DRAIN_LOG_CHUNK_SAMPLES != 0) {
+        persist_read_data(DRAIN_LOG_CHUNK_KEY + state.count / DRAIN_LOG_CHUNK_SAMPLES % DRAIN_LOG_CHUNKS, chunk, sizeof(chunk));
+    }
+
+    charge = battery_state_service_peek();
+    log_sample();
+    battery_state_service_subscribe(&battery_change);
+    app_worker_message_subscribe(&message_received);
+}
+
+static void do_deinit(void) {
+    app_worker_message_unsubscribe();
+    battery_state_service_unsubscribe();
+}
+
+int main(void) {
+    do_init();
+    worker_event_loop();
+    do_deinit();
+}